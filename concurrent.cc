@@ -0,0 +1,104 @@
+#include "concurrent.h"
+
+using showtime::Concurrent;
+using showtime::Clock;
+
+Concurrent::~Concurrent()
+{
+    drain();
+}
+
+/**
+ * Add a timer as if by Clock::add(t, tm), once the owner gets to it.
+ * Returns true if the owner may need to be woken up.
+ */
+bool Concurrent::add(Clock::time_point t, Timer* tm)
+{
+    return request(tm, t.time_since_epoch().count());
+}
+
+/**
+ * Remove a timer as if by Clock::remove(tm), once the owner gets to
+ * it. Returns true if the owner may need to be woken up.
+ */
+bool Concurrent::remove(Timer* tm)
+{
+    return request(tm, Timer::Request::removal);
+}
+
+/**
+ * Carry out everyone's requests, in the order the timers were first
+ * asked about since the last drain().
+ *
+ * A timer's request is taken (and reset to none) only after we're
+ * done with its link in the stack: from then on another thread may
+ * push it again.
+ */
+void Concurrent::drain()
+{
+    Timer* tm = head.exchange(nullptr, std::memory_order_acquire);
+
+    Timer* fifo = nullptr;
+    while (tm) {
+	Timer* const next = tm->request.next;
+	tm->request.next = fifo;
+	fifo = tm;
+	tm = next;
+    }
+
+    while (fifo) {
+	Timer* const next = fifo->request.next;
+	const Clock::rep t = fifo->request.t.exchange(Timer::Request::none,
+							 std::memory_order_acq_rel);
+	if (t == Timer::Request::removal) {
+	    clock.remove(fifo);
+	}
+	else {
+	    clock.add(Clock::time_point {Clock::duration {t}}, fifo);
+	}
+	fifo = next;
+    }
+}
+
+/**
+ * Clock::set(t), after taking care of the requests.
+ */
+Clock::Ramifications Concurrent::set(Clock::time_point t)
+{
+    drain();
+    return clock.set(t);
+}
+
+Clock::ref::duration Concurrent::set(Clock::time_point t,
+				     std::vector<Timer*>& elapsed)
+{
+    drain();
+    return clock.set(t, elapsed);
+}
+
+/**
+ * Clock::dispatch(t), after taking care of the requests.
+ */
+Clock::ref::duration Concurrent::dispatch(Clock::time_point t)
+{
+    drain();
+    return clock.dispatch(t);
+}
+
+/* Make t the timer's request. If it had none pending, push it onto
+ * the stack of timers with requests (it's reversed to a queue when
+ * drained), and return true if the stack was empty before.
+ */
+bool Concurrent::request(Timer* tm, Clock::rep t)
+{
+    const Clock::rep was = tm->request.t.exchange(t, std::memory_order_acq_rel);
+    if (was != Timer::Request::none) return false;
+
+    Timer* old = head.load(std::memory_order_relaxed);
+    do {
+	tm->request.next = old;
+    } while (!head.compare_exchange_weak(old, tm,
+					 std::memory_order_release,
+					 std::memory_order_relaxed));
+    return !old;
+}
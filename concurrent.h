@@ -0,0 +1,58 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_CONCURRENT_H_
+#define SHOWTIME_CONCURRENT_H_
+
+#include "showtime.h"
+
+#include <atomic>
+
+namespace showtime {
+
+    /**
+     * A Clock is single-threaded, but this lets other threads add
+     * and remove its timers. Their requests go on a lock-free queue
+     * which the thread owning the Clock drains in set() (or
+     * drain()), before anything else happens. No locks are taken by
+     * anyone.
+     *
+     * Since the owning thread may be asleep, waiting for the snooze
+     * time to pass, add() and remove() tell when the queue was
+     * empty: then it's up to the caller to wake the owner up.
+     *
+     * The requests are embedded in the Timer (about 16 bytes in
+     * every Timer), so nothing is allocated, and a timer has at
+     * most one request pending: a later add() or remove() replaces
+     * the earlier one, which comes to the same thing once the owner
+     * gets to it. A timer is used with one Concurrent at a time.
+     *
+     * On the other threads, the Timer::cancelled flag and cancel()
+     * are off limits (use remove() instead) and so is destroying a
+     * Timer which may be scheduled.
+     */
+    class Concurrent {
+    public:
+	explicit Concurrent(Clock& clock) : clock(clock) {}
+	Concurrent(const Concurrent&) = delete;
+	Concurrent& operator= (const Concurrent&) = delete;
+	~Concurrent();
+
+	/* any thread */
+	bool add(Clock::time_point t, Timer* tm);
+	bool remove(Timer* tm);
+
+	/* the owner's thread */
+	void drain();
+	Clock::Ramifications set(Clock::time_point t);
+	Clock::ref::duration set(Clock::time_point t, std::vector<Timer*>& elapsed);
+	Clock::ref::duration dispatch(Clock::time_point t);
+
+    private:
+	Clock& clock;
+	std::atomic<Timer*> head {nullptr};
+
+	bool request(Timer* tm, Clock::rep t);
+    };
+}
+#endif
@@ -0,0 +1,62 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_CORO_H_
+#define SHOWTIME_CORO_H_
+
+#include "showtime.h"
+#include "runner.h"
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+
+namespace showtime {
+
+    /**
+     * Sleeping in a C++20 coroutine:
+     *
+     *     co_await Sleep {clock, now, minutes{5}};
+     *
+     * The Sleep is itself the Timer, and lives in the coroutine
+     * frame, so there's nothing to allocate and nothing to look up:
+     * when it elapses in Clock::dispatch() (or Runner::run()) the
+     * coroutine is resumed, right there. Use set() with a list of
+     * elapsed timers instead, and it's up to you to fire() them.
+     *
+     * Destroying a coroutine which is asleep removes its timer, so
+     * that's how to cancel a timeout.
+     *
+     * Only for C++20 and later; the rest of the library doesn't need
+     * it.
+     */
+    class Sleep : public Timer {
+    public:
+	Sleep(Clock& clock, Clock::time_point now, Clock::duration dt)
+	    : Timer {dt},
+	      clock {&clock},
+	      now {now}
+	{}
+	Sleep(Runner& runner, Clock::duration dt)
+	    : Timer {dt},
+	      runner {&runner}
+	{}
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> h) {
+	    handle = h;
+	    if (runner) runner->add(this);
+	    else clock->add(now, this);
+	}
+	void await_resume() const noexcept {}
+
+	void fire() override { handle.resume(); }
+
+    private:
+	Clock* clock = nullptr;
+	Runner* runner = nullptr;
+	Clock::time_point now;
+	std::coroutine_handle<> handle;
+    };
+}
+#endif
+#endif
@@ -0,0 +1,96 @@
+#include "group.h"
+
+using showtime::Group;
+using showtime::Clock;
+
+/**
+ * Add a clock to the group; joining twice is the same as update().
+ */
+void Group::join(Clock& clock)
+{
+    auto it = members.find(&clock);
+    if (it != members.end()) {
+	key(it->second, clock, clock.deadline());
+	return;
+    }
+    members.emplace(&clock, queue.emplace(clock.deadline(), &clock));
+}
+
+void Group::leave(Clock& clock)
+{
+    auto it = members.find(&clock);
+    if (it == members.end()) return;
+    queue.erase(it->second);
+    members.erase(it);
+}
+
+/**
+ * Find the clock's place in the group again, after it was changed.
+ */
+void Group::update(Clock& clock)
+{
+    auto it = members.find(&clock);
+    if (it == members.end()) return;
+    key(it->second, clock, clock.deadline());
+}
+
+/**
+ * Clock::add() on a member, at reference time 'now'.
+ */
+void Group::add(Clock& clock, ref::time_point now, Timer* tm)
+{
+    clock.add(clock.at(now), tm);
+    update(clock);
+}
+
+/**
+ * Set the clocks which are due at reference time 'now', appending
+ * their elapsed timers: one clock's timers in time order, then the
+ * next clock's. Returns the group's deadline(). Clocks which aren't
+ * due aren't touched.
+ */
+Group::ref::time_point Group::set(ref::time_point now, std::vector<Timer*>& elapsed)
+{
+    while (!queue.empty() && queue.begin()->first <= now) {
+	Clock& clock = *queue.begin()->second;
+	auto& it = members.at(&clock);
+	key(it, clock, clock.set_until(clock.at(now), elapsed));
+    }
+    return deadline();
+}
+
+/**
+ * Like set(now, elapsed), but with Clock::dispatch(). The timers'
+ * fire() may use the group.
+ */
+Group::ref::time_point Group::dispatch(ref::time_point now)
+{
+    while (!queue.empty() && queue.begin()->first <= now) {
+	Clock& clock = *queue.begin()->second;
+	clock.dispatch(clock.at(now));
+
+	/* fire() may have made it leave, too */
+	const auto it = members.find(&clock);
+	if (it != members.end()) key(it->second, clock, clock.deadline());
+    }
+    return deadline();
+}
+
+/**
+ * The reference time when the first timer of any clock strikes, or
+ * max() if none ever will.
+ */
+Group::ref::time_point Group::deadline() const
+{
+    if (queue.empty()) return ref::time_point::max();
+    return queue.begin()->first;
+}
+
+/* Move the clock's entry to t, unless it's there already.
+ */
+void Group::key(Queue::iterator& it, Clock& clock, ref::time_point t)
+{
+    if (it->first == t) return;
+    queue.erase(it);
+    it = queue.emplace(t, &clock);
+}
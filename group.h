@@ -0,0 +1,53 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_GROUP_H_
+#define SHOWTIME_GROUP_H_
+
+#include "showtime.h"
+
+#include <map>
+
+namespace showtime {
+
+    /**
+     * Clocks which share a reference clock (they all do) and a
+     * wakeup: a group of them, ordered by when their first timers
+     * strike, in reference time. set(now) only sets the clocks which
+     * are due, and tells when the next one is, so there's a single
+     * wakeup for all of them.
+     *
+     * The group doesn't own the clocks. It has to know when a
+     * clock's deadline may have moved: add timers through it, or
+     * call update() after changing the clock directly, e.g. with
+     * Clock::change().
+     */
+    class Group {
+    public:
+	using ref = Clock::ref;
+
+	Group() = default;
+	Group(const Group&) = delete;
+	Group& operator= (const Group&) = delete;
+
+	void join(Clock& clock);
+	void leave(Clock& clock);
+	void update(Clock& clock);
+	std::size_t size() const { return members.size(); }
+
+	void add(Clock& clock, ref::time_point now, Timer* tm);
+
+	ref::time_point set(ref::time_point now, std::vector<Timer*>& elapsed);
+	ref::time_point dispatch(ref::time_point now);
+	ref::time_point deadline() const;
+
+    private:
+	using Queue = std::multimap<ref::time_point, Clock*>;
+
+	Queue queue;
+	std::map<Clock*, Queue::iterator> members;
+
+	void key(Queue::iterator& it, Clock& clock, ref::time_point t);
+    };
+}
+#endif
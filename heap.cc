@@ -0,0 +1,141 @@
+#include "heap.h"
+
+#include <algorithm>
+
+using showtime::Heap;
+
+Heap::~Heap()
+{
+    for (Entry& e : v) hook(e.tm).s = nullptr;
+}
+
+void Heap::insert(time_point t, Timer* const tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s) h.s->remove(tm);
+
+    h.s = this;
+    h.t = t;
+    h.n = seq++;
+    v.push_back({t, tm});
+    h.where = v.size() - 1;
+    sift_up(v.size() - 1);
+}
+
+/**
+ * Insert a sorted batch. They're appended one by one, but in a heap
+ * of mostly earlier timers (like an empty one) each one stays where
+ * it's put, so that's O(1) each.
+ */
+void Heap::insert(Entry* a, Entry* b)
+{
+    v.reserve(v.size() + (b - a));
+    Schedule::insert(a, b);
+}
+
+const Heap::Entry* Heap::front()
+{
+    if (v.empty()) return nullptr;
+    return &v.front();
+}
+
+bool Heap::pop(time_point t, Entry& e)
+{
+    if (v.empty() || v.front().t > t) return false;
+    e = v.front();
+    take(0);
+    hook(e.tm).s = nullptr;
+    return true;
+}
+
+void Heap::remove(Timer* tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s != this) return;
+    take(h.where);
+    h.s = nullptr;
+}
+
+/**
+ * Sorting the heap, so O(n log n).
+ */
+void Heap::list(std::vector<Entry>& out) const
+{
+    const std::size_t n = out.size();
+    out.insert(out.end(), v.begin(), v.end());
+    std::sort(out.begin() + n, out.end(), less);
+}
+
+/**
+ * Squeezing out the cancelled timers, then making a heap of the rest
+ * in O(n).
+ */
+void Heap::compact()
+{
+    std::size_t j = 0;
+    for (const Entry& e : v) {
+	if (e.tm->cancelled) {
+	    hook(e.tm).s = nullptr;
+	    continue;
+	}
+	set(j++, e);
+    }
+    v.resize(j);
+    for (std::size_t i = (j+2)/4; i--; ) sift_down(i);
+}
+
+bool Heap::less(const Entry& a, const Entry& b)
+{
+    if (a.t != b.t) return a.t < b.t;
+    return hook(a.tm).n < hook(b.tm).n;
+}
+
+void Heap::set(std::size_t i, const Entry& e)
+{
+    v[i] = e;
+    hook(e.tm).where = i;
+}
+
+/* Remove the entry at i, filling the hole with the last one.
+ */
+void Heap::take(std::size_t i)
+{
+    const Entry last = v.back();
+    v.pop_back();
+    if (i == v.size()) return;
+
+    set(i, last);
+    if (i && less(v[i], v[(i-1)/4])) sift_up(i);
+    else sift_down(i);
+}
+
+void Heap::sift_up(std::size_t i)
+{
+    const Entry e = v[i];
+    while (i) {
+	const std::size_t parent = (i-1)/4;
+	if (!less(e, v[parent])) break;
+	set(i, v[parent]);
+	i = parent;
+    }
+    set(i, e);
+}
+
+void Heap::sift_down(std::size_t i)
+{
+    const Entry e = v[i];
+    const std::size_t n = v.size();
+    for (;;) {
+	const std::size_t first = 4*i + 1;
+	if (first >= n) break;
+	const std::size_t end = std::min(first + 4, n);
+	std::size_t best = first;
+	for (std::size_t c = first + 1; c < end; c++) {
+	    if (less(v[c], v[best])) best = c;
+	}
+	if (!less(v[best], e)) break;
+	set(i, v[best]);
+	i = best;
+    }
+    set(i, e);
+}
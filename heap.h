@@ -0,0 +1,54 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_HEAP_H_
+#define SHOWTIME_HEAP_H_
+
+#include "showtime.h"
+
+#include <cstdint>
+
+namespace showtime {
+
+    /**
+     * A 4-ary min-heap in one vector, as a Schedule. The entries are
+     * just time and timer, 16 bytes, so four children of a node share
+     * a cache line, and there are no nodes to chase. A timer's hook
+     * remembers its index (in 'where'), so removal is O(log n).
+     *
+     * Timers at the same time are told apart by a sequence number in
+     * the hook's 'n'; only then does the heap look at the timer
+     * itself.
+     *
+     * Inserting a sorted batch into an empty heap is O(n), since a
+     * sorted array is already a heap.
+     */
+    class Heap : public Schedule {
+    public:
+	Heap() = default;
+	Heap(const Heap&) = delete;
+	Heap& operator= (const Heap&) = delete;
+	~Heap();
+
+	void insert(time_point t, Timer* tm) override;
+	void insert(Entry* a, Entry* b) override;
+	const Entry* front() override;
+	bool pop(time_point t, Entry& e) override;
+	void remove(Timer* tm) override;
+	std::size_t size() const override { return v.size(); }
+	void list(std::vector<Entry>& out) const override;
+
+    private:
+	void compact() override;
+
+	std::vector<Entry> v;
+	std::uint64_t seq = 0;
+
+	static bool less(const Entry& a, const Entry& b);
+	void set(std::size_t i, const Entry& e);
+	void take(std::size_t i);
+	void sift_up(std::size_t i);
+	void sift_down(std::size_t i);
+    };
+}
+#endif
@@ -0,0 +1,234 @@
+#include "lists.h"
+
+#include <algorithm>
+
+using showtime::Lists;
+
+Lists::~Lists()
+{
+    for (auto& kv : heads) hook(kv.second).s = nullptr;
+    for (auto& kv : lists) {
+	const List& l = kv.second;
+	for (std::size_t i = l.first; i < l.q.size(); i++) {
+	    if (l.q[i].tm) hook(l.q[i].tm).s = nullptr;
+	}
+    }
+}
+
+/**
+ * Insert tm at t: at the end of the list for its dt, unless that
+ * would put it out of order.
+ */
+void Lists::insert(time_point t, Timer* const tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s) h.s->remove(tm);
+
+    const Item item {t, seq++, tm};
+    h.s = this;
+    h.t = t;
+    n++;
+
+    List& l = find(tm->dt);
+    if (l.empty() || l.q.back().t <= t) {
+	h.where = listed;
+	h.n = l.base + l.q.size();
+	h.p = &l;
+	l.q.push_back(item);
+	if (l.q.size() - l.first==1) heads.emplace(Key {t, item.seq}, tm);
+	return;
+    }
+
+    h.where = alone;
+    h.n = item.seq;
+    heads.emplace(Key {t, item.seq}, tm);
+}
+
+const Lists::Entry* Lists::front()
+{
+    if (heads.empty()) return nullptr;
+    const auto& kv = *heads.begin();
+    head = {kv.first.t, kv.second};
+    return &head;
+}
+
+bool Lists::pop(time_point t, Entry& e)
+{
+    if (heads.empty()) return false;
+    auto it = heads.begin();
+    if (it->first.t > t) return false;
+
+    Timer* const tm = it->second;
+    e = {it->first.t, tm};
+    heads.erase(it);
+
+    Timer::Hook& h = hook(tm);
+    h.s = nullptr;
+    n--;
+    if (h.where==listed) behead(*static_cast<List*>(h.p));
+    return true;
+}
+
+std::size_t Lists::size() const
+{
+    return n;
+}
+
+/**
+ * Merging the lists and the timers which aren't in lists, by
+ * sorting them.
+ */
+void Lists::list(std::vector<Entry>& v) const
+{
+    std::vector<Item> items;
+    for (auto& kv : heads) {
+	if (hook(kv.second).where==alone) items.push_back({kv.first.t, kv.first.seq, kv.second});
+    }
+    for (auto& kv : lists) {
+	const List& l = kv.second;
+	for (std::size_t i = l.first; i < l.q.size(); i++) {
+	    if (l.q[i].tm) items.push_back(l.q[i]);
+	}
+    }
+    std::sort(begin(items), end(items), [] (const Item& a, const Item& b) {
+				       if (a.t != b.t) return a.t < b.t;
+				       return a.seq < b.seq;
+				   });
+    for (const Item& item : items) v.push_back({item.t, item.tm});
+}
+
+/**
+ * The cancelled timers not in lists are taken out of the map, and
+ * the listed ones become holes, which are then squeezed out.
+ */
+void Lists::compact()
+{
+    auto it = heads.begin();
+    while (it != heads.end()) {
+	Timer* const tm = it->second;
+	Timer::Hook& h = hook(tm);
+	if (h.where==alone && tm->cancelled) {
+	    h.s = nullptr;
+	    n--;
+	    it = heads.erase(it);
+	}
+	else {
+	    it++;
+	}
+    }
+
+    auto jt = lists.begin();
+    while (jt != lists.end()) {
+	List& l = jt->second;
+	const Item& front = l.q[l.first];
+	const bool beheaded = front.tm->cancelled;
+	if (beheaded) heads.erase(Key {front.t, front.seq});
+
+	const std::size_t holes = l.holes;
+	for (std::size_t i = l.first; i < l.q.size(); i++) {
+	    Item& item = l.q[i];
+	    if (!item.tm || !item.tm->cancelled) continue;
+	    hook(item.tm).s = nullptr;
+	    item.tm = nullptr;
+	    l.holes++;
+	}
+	n -= l.holes - holes;
+	if (l.holes) compact(l);
+
+	if (l.empty()) {
+	    if (last==&l) last = nullptr;
+	    jt = lists.erase(jt);
+	    continue;
+	}
+	if (beheaded) {
+	    const Item& item = l.q[l.first];
+	    heads.emplace(Key {item.t, item.seq}, item.tm);
+	}
+	jt++;
+    }
+}
+
+void Lists::remove(Timer* tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s != this) return;
+    h.s = nullptr;
+    n--;
+
+    if (h.where==alone) {
+	heads.erase(Key {h.t, h.n});
+	return;
+    }
+
+    List& l = *static_cast<List*>(h.p);
+    const std::size_t i = h.n - l.base;
+    Item& item = l.q[i];
+    if (i==l.first) {
+	heads.erase(Key {item.t, item.seq});
+	behead(l);
+	return;
+    }
+
+    item.tm = nullptr;
+    l.holes++;
+    if (l.holes >= 16 && 2*l.holes > l.q.size() - l.first) compact(l);
+}
+
+/* The list for dt, made if there isn't one. The last one is
+ * remembered, since timers often come in runs with the same dt.
+ */
+Lists::List& Lists::find(Clock::duration dt)
+{
+    if (last && last->dt==dt) return *last;
+    auto it = lists.find(dt);
+    if (it==lists.end()) it = lists.emplace(dt, List {dt}).first;
+    last = &it->second;
+    return *last;
+}
+
+/* The head of a list is gone from the map. Take it off the list,
+ * along with any holes after it, and let the next one be the head.
+ * An empty list is dropped, so there's no build-up of lists for
+ * durations no longer in use. What's been taken off is freed once
+ * it's half the list.
+ */
+void Lists::behead(List& l)
+{
+    l.first++;
+    while (!l.empty() && !l.q[l.first].tm) {
+	l.first++;
+	l.holes--;
+    }
+
+    if (l.empty()) {
+	if (last==&l) last = nullptr;
+	lists.erase(l.dt);
+	return;
+    }
+    if (l.first >= 16 && 2*l.first >= l.q.size()) {
+	l.q.erase(begin(l.q), begin(l.q) + l.first);
+	l.base += l.first;
+	l.first = 0;
+    }
+    const Item& item = l.q[l.first];
+    heads.emplace(Key {item.t, item.seq}, item.tm);
+}
+
+/* Squeeze the holes out of a list, moving the timers after them.
+ */
+void Lists::compact(List& l)
+{
+    std::vector<Item> q;
+    q.reserve(l.q.size() - l.first - l.holes);
+    const std::size_t base = l.base + l.first;
+    for (std::size_t i = l.first; i < l.q.size(); i++) {
+	const Item& item = l.q[i];
+	if (!item.tm) continue;
+	hook(item.tm).n = base + q.size();
+	q.push_back(item);
+    }
+    l.q.swap(q);
+    l.base = base;
+    l.first = 0;
+    l.holes = 0;
+}
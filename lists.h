@@ -0,0 +1,98 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_LISTS_H_
+#define SHOWTIME_LISTS_H_
+
+#include "showtime.h"
+
+#include <cstdint>
+#include <map>
+
+namespace showtime {
+
+    /**
+     * A Schedule for many timers with the same few durations, like
+     * idle timeouts: timers with the same dt, added in time order,
+     * are also due in that order. So each dt gets a FIFO list, and
+     * only the head of each list is in the (small) ordered map of
+     * what's due first. Adding to a list is O(1), and so is taking
+     * the head off it, apart from putting the next head in the map.
+     *
+     * A timer which is earlier than the tail of its list (it was
+     * added with an earlier time than a previous one with the same
+     * dt) goes straight into the map, so any mix of timers works;
+     * it's just slower.
+     *
+     * A timer on a list knows its list (through its Hook), so only
+     * insert() looks the list up, and not when it's the same dt as
+     * last time. Even so, a dt which only one timer has costs more
+     * than in a Map: this is for a handful of durations shared by
+     * many timers, not for all durations being different.
+     *
+     * Removing from the middle of a list leaves a hole, which
+     * remains until the head of the list gets there, or until the
+     * holes are more than half of the list and it's compacted.
+     */
+    class Lists : public Schedule {
+    public:
+	Lists() = default;
+	Lists(const Lists&) = delete;
+	Lists& operator= (const Lists&) = delete;
+	~Lists();
+
+	using Schedule::insert;
+	void insert(time_point t, Timer* tm) override;
+	const Entry* front() override;
+	bool pop(time_point t, Entry& e) override;
+	void remove(Timer* tm) override;
+	std::size_t size() const override;
+	void list(std::vector<Entry>& v) const override;
+
+    private:
+	void compact() override;
+
+	struct Key {
+	    time_point t;
+	    std::uint64_t seq;
+	    bool operator< (const Key& other) const {
+		if (t != other.t) return t < other.t;
+		return seq < other.seq;
+	    }
+	};
+	struct Item {
+	    time_point t;
+	    std::uint64_t seq;
+	    Timer* tm;
+	};
+	/* q[first] is the head; the timer at q[i] has its Hook's n
+	 * at base + i.
+	 */
+	struct List {
+	    explicit List(Clock::duration dt) : dt {dt} {}
+	    Clock::duration dt;
+	    std::vector<Item> q;
+	    std::size_t first = 0;
+	    std::size_t holes = 0;
+	    std::size_t base = 0;
+	    bool empty() const { return first==q.size(); }
+	};
+	using Heads = std::map<Key, Timer*>;
+	using Fifos = std::map<Clock::duration, List>;
+
+	Heads heads;
+	Fifos lists;
+	List* last = nullptr;
+	std::uint64_t seq = 0;
+	std::size_t n = 0;
+	Entry head;
+
+	static constexpr unsigned alone = 0;
+	static constexpr unsigned listed = 1;
+
+	List& find(Clock::duration dt);
+	void behead(List& l);
+	void compact(List& l);
+    };
+}
+#endif
@@ -0,0 +1,117 @@
+#include "map.h"
+
+using showtime::Map;
+
+Map::Map()
+    : own {new Pool},
+      timers {Pool::Allocator<value_type>{*own}}
+{}
+
+Map::Map(Pool& pool)
+    : timers {Pool::Allocator<value_type>{pool}}
+{}
+
+Map::~Map()
+{
+    for (auto& kv : timers) hook(kv.second).s = nullptr;
+}
+
+/**
+ * Insert tm at t, after any other timers at t. New timers tend to go
+ * last, so that's the hint; then inserting is amortized O(1).
+ */
+void Map::insert(time_point t, Timer* const tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s) h.s->remove(tm);
+
+    const Key key {t, seq++};
+    timers.emplace_hint(timers.end(), key, tm);
+    h.s = this;
+    h.t = t;
+    h.n = key.seq;
+}
+
+/**
+ * Insert a sorted batch, each one just before the successor of the
+ * last. That's O(1) for every timer which doesn't have other timers
+ * between itself and its predecessor in the batch, or else O(log n).
+ */
+void Map::insert(Entry* a, Entry* b)
+{
+    for (Entry* e = a; e != b; e++) {
+	Timer::Hook& h = hook(e->tm);
+	if (h.s) h.s->remove(e->tm);
+    }
+
+    auto hint = timers.end();
+    for (; a != b; a++) {
+	Timer* const tm = a->tm;
+	Timer::Hook& h = hook(tm);
+	if (h.s) {
+	    /* It's in the batch twice. */
+	    insert(a->t, tm);
+	    hint = timers.end();
+	    continue;
+	}
+
+	const Key key {a->t, seq++};
+	hint = timers.emplace_hint(hint, key, tm);
+	hint++;
+	h.s = this;
+	h.t = a->t;
+	h.n = key.seq;
+    }
+}
+
+const Map::Entry* Map::front()
+{
+    if (timers.empty()) return nullptr;
+    const auto& kv = *timers.begin();
+    head = {kv.first.t, kv.second};
+    return &head;
+}
+
+bool Map::pop(time_point t, Entry& e)
+{
+    if (timers.empty()) return false;
+    auto it = timers.begin();
+    if (it->first.t > t) return false;
+    e = {it->first.t, it->second};
+    hook(e.tm).s = nullptr;
+    timers.erase(it);
+    return true;
+}
+
+std::size_t Map::size() const
+{
+    return timers.size();
+}
+
+void Map::list(std::vector<Entry>& v) const
+{
+    for (auto& kv : timers) v.push_back({kv.first.t, kv.second});
+}
+
+void Map::compact()
+{
+    auto it = timers.begin();
+    while (it != timers.end()) {
+	Timer* const tm = it->second;
+	if (tm->cancelled) {
+	    hook(tm).s = nullptr;
+	    it = timers.erase(it);
+	}
+	else {
+	    it++;
+	}
+    }
+}
+
+void Map::remove(Timer* tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s != this) return;
+    timers.erase(Key {h.t, h.n});
+    h.s = nullptr;
+}
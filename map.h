@@ -0,0 +1,61 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_MAP_H_
+#define SHOWTIME_MAP_H_
+
+#include "showtime.h"
+#include "pool.h"
+
+#include <cstdint>
+#include <map>
+
+namespace showtime {
+
+    /**
+     * The original Schedule: a std::map from time to Timer. The key
+     * also has a sequence number, so timers at the same time are
+     * kept in the order they came, and none has to be moved. A
+     * timer's hook remembers its key, so removal is O(log n).
+     *
+     * The map's nodes come from a Pool, either the Map's own or one
+     * shared with others in the same event loop.
+     */
+    class Map : public Schedule {
+    public:
+	Map();
+	explicit Map(Pool& pool);
+	Map(const Map&) = delete;
+	Map& operator= (const Map&) = delete;
+	~Map();
+
+	void insert(time_point t, Timer* tm) override;
+	void insert(Entry* a, Entry* b) override;
+	const Entry* front() override;
+	bool pop(time_point t, Entry& e) override;
+	void remove(Timer* tm) override;
+	std::size_t size() const override;
+	void list(std::vector<Entry>& v) const override;
+
+    private:
+	void compact() override;
+
+	struct Key {
+	    time_point t;
+	    std::uint64_t seq;
+	    bool operator< (const Key& other) const {
+		if (t != other.t) return t < other.t;
+		return seq < other.seq;
+	    }
+	};
+	using value_type = std::pair<const Key, Timer*>;
+
+	std::unique_ptr<Pool> own;
+	std::map<Key, Timer*,
+		 std::less<Key>,
+		 Pool::Allocator<value_type>> timers;
+	std::uint64_t seq = 0;
+	Entry head;
+    };
+}
+#endif
@@ -0,0 +1,58 @@
+#include "pool.h"
+
+#include <algorithm>
+#include <new>
+
+using showtime::Pool;
+
+Pool::~Pool()
+{
+    for (void* p : chunks) ::operator delete(p);
+}
+
+void* Pool::allocate(std::size_t size)
+{
+    if (!size) size = 1;
+    const std::size_t c = (size - 1) / align;
+    if (c >= classes) return ::operator new(size);
+
+    if (!free[c]) refill(c);
+    Block* const b = free[c];
+    free[c] = b->next;
+    return b;
+}
+
+void Pool::deallocate(void* p, std::size_t size)
+{
+    if (!size) size = 1;
+    const std::size_t c = (size - 1) / align;
+    if (c >= classes) {
+	::operator delete(p);
+	return;
+    }
+
+    Block* const b = static_cast<Block*>(p);
+    b->next = free[c];
+    free[c] = b;
+}
+
+/* Put a new, bigger chunk of blocks of size class 'c' on its free
+ * list. Chunks grow with the number of blocks handed out so far, so
+ * that a few large chunks serve a large schedule.
+ */
+void Pool::refill(std::size_t c)
+{
+    const std::size_t size = (c + 1) * align;
+    const std::size_t n = std::min<std::size_t>(std::max<std::size_t>(carved[c], 32), 4096);
+
+    chunks.reserve(chunks.size() + 1);
+    char* const chunk = static_cast<char*>(::operator new(n * size));
+    chunks.push_back(chunk);
+    carved[c] += n;
+
+    for (std::size_t i = n; i; i--) {
+	Block* const b = reinterpret_cast<Block*>(chunk + (i-1) * size);
+	b->next = free[c];
+	free[c] = b;
+    }
+}
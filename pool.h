@@ -0,0 +1,74 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_POOL_H_
+#define SHOWTIME_POOL_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace showtime {
+
+    /**
+     * A memory pool for small objects, like the nodes of a std::map.
+     * Memory is carved out of chunks and put on a free list per size
+     * (in steps of 16 bytes, up to 256), and freed only when the Pool
+     * is destroyed. Larger requests go to operator new.
+     *
+     * Not thread-safe, but that's the point: one per event loop, and
+     * no contention with the others.
+     */
+    class Pool {
+    public:
+	Pool() = default;
+	Pool(const Pool&) = delete;
+	Pool& operator= (const Pool&) = delete;
+	~Pool();
+
+	void* allocate(std::size_t size);
+	void deallocate(void* p, std::size_t size);
+
+	template <class T> class Allocator;
+
+    private:
+	static constexpr std::size_t align = alignof(std::max_align_t);
+	static constexpr std::size_t classes = 256 / align;
+
+	struct Block { Block* next; };
+	Block* free[classes] = {};
+	std::size_t carved[classes] = {};
+	std::vector<void*> chunks;
+
+	void refill(std::size_t c);
+    };
+
+    /**
+     * Pool as a standard allocator.
+     */
+    template <class T>
+    class Pool::Allocator {
+    public:
+	using value_type = T;
+
+	explicit Allocator(Pool& pool) : pool{&pool} {}
+	template <class U>
+	Allocator(const Allocator<U>& other) : pool{other.pool} {}
+
+	T* allocate(std::size_t n) {
+	    return static_cast<T*>(pool->allocate(n * sizeof(T)));
+	}
+	void deallocate(T* p, std::size_t n) {
+	    pool->deallocate(p, n * sizeof(T));
+	}
+
+	template <class U>
+	bool operator== (const Allocator<U>& other) const { return pool==other.pool; }
+	template <class U>
+	bool operator!= (const Allocator<U>& other) const { return pool!=other.pool; }
+
+    private:
+	template <class U> friend class Allocator;
+	Pool* pool;
+    };
+}
+#endif
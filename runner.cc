@@ -0,0 +1,115 @@
+#include "runner.h"
+
+#include <system_error>
+
+#include <sys/timerfd.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+
+using showtime::Runner;
+using showtime::Clock;
+
+namespace {
+
+    [[noreturn]] void fail(const char* what)
+    {
+	throw std::system_error(errno, std::system_category(), what);
+    }
+
+    int timerfd()
+    {
+	const int fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd==-1) fail("timerfd_create");
+	return fd;
+    }
+}
+
+Runner::Runner(Clock& clock)
+    : clock(clock),
+      tfd {timerfd()},
+      armed {Clock::ref::time_point::max()}
+{}
+
+Runner::~Runner()
+{
+    close(tfd);
+}
+
+/**
+ * Add fd() to an epoll set, for reading. The event's data is a
+ * pointer to this Runner.
+ */
+void Runner::watch(int epfd)
+{
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = this;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, &ev)) fail("epoll_ctl");
+}
+
+/**
+ * Clock::add() at the current time, re-arming if the timer is the
+ * new first one.
+ */
+void Runner::add(Timer* tm)
+{
+    const auto now = Clock::ref::now();
+    clock.add(clock.at(now), tm);
+    const auto t = clock.deadline();
+    if (t < armed) settime(t);
+}
+
+/**
+ * Clock::remove(). The timerfd is left as it is; at worst it strikes
+ * once for nothing.
+ */
+void Runner::remove(Timer* tm)
+{
+    clock.remove(tm);
+}
+
+/**
+ * Set the clock to the current time, append the elapsed timers, and
+ * arm for the next one. Call it when fd() is readable, or whenever
+ * you like.
+ */
+void Runner::run(std::vector<Timer*>& elapsed)
+{
+    const auto now = Clock::ref::now();
+    settime(clock.set_until(clock.at(now), elapsed));
+}
+
+/**
+ * Like run(elapsed), but with Clock::dispatch(): the elapsed timers
+ * fire().
+ */
+void Runner::run()
+{
+    const auto now = Clock::ref::now();
+    clock.dispatch(clock.at(now));
+    settime(clock.deadline());
+}
+
+/* Arm the timerfd for t (and clear it), or disarm it if t is max().
+ * A t before the epoch, which the kernel won't take, means as soon as
+ * possible.
+ */
+void Runner::settime(Clock::ref::time_point t)
+{
+    using namespace std::chrono;
+
+    itimerspec its = {};
+    if (t != Clock::ref::time_point::max()) {
+	const auto d = t.time_since_epoch();
+	const auto s = duration_cast<seconds>(d);
+	if (d.count() > 0) {
+	    its.it_value.tv_sec = s.count();
+	    its.it_value.tv_nsec = duration_cast<nanoseconds>(d - s).count();
+	}
+	if (!its.it_value.tv_sec && !its.it_value.tv_nsec) its.it_value.tv_nsec = 1;
+    }
+
+    if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, nullptr)) fail("timerfd_settime");
+    armed = t;
+}
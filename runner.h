@@ -0,0 +1,50 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_RUNNER_H_
+#define SHOWTIME_RUNNER_H_
+
+#include "showtime.h"
+
+namespace showtime {
+
+    /**
+     * Runs a Clock against the real system clock, using a Linux
+     * timerfd. The timerfd is armed with the absolute time (in
+     * CLOCK_REALTIME, which is what std::chrono::system_clock is)
+     * of the first timer (see Clock::deadline()), or disarmed if
+     * there are none, or if the clock is stopped.
+     *
+     * Put fd() in your epoll set, or let watch() do it; when it's
+     * readable, call run(). Since re-arming the timerfd also clears
+     * it, that's one system call per wakeup.
+     *
+     * Add and remove timers here rather than directly on the Clock,
+     * so the timerfd follows; after a Clock::change(), call run().
+     *
+     * Errors from the system are thrown as std::system_error.
+     */
+    class Runner {
+    public:
+	explicit Runner(Clock& clock);
+	Runner(const Runner&) = delete;
+	Runner& operator= (const Runner&) = delete;
+	~Runner();
+
+	int fd() const { return tfd; }
+	void watch(int epfd);
+
+	void add(Timer* tm);
+	void remove(Timer* tm);
+	void run(std::vector<Timer*>& elapsed);
+	void run();
+
+    private:
+	Clock& clock;
+	const int tfd;
+	Clock::ref::time_point armed;
+
+	void settime(Clock::ref::time_point t);
+    };
+}
+#endif
@@ -0,0 +1,104 @@
+#include "shards.h"
+#include "wheel.h"
+
+#include <cstdint>
+
+using showtime::Shards;
+using showtime::Clock;
+
+/**
+ * n shards, each with a Wheel.
+ */
+Shards::Shards(unsigned n)
+{
+    while (n--) {
+	shards.emplace_back(new Shard {std::unique_ptr<Schedule>{new Wheel}});
+    }
+}
+
+/**
+ * One shard per Schedule.
+ */
+Shards::Shards(std::vector<std::unique_ptr<Schedule>> schedules)
+{
+    for (auto& s : schedules) {
+	shards.emplace_back(new Shard {std::move(s)});
+    }
+}
+
+/**
+ * The shard a timer goes to, unless you choose. Addresses aren't
+ * very random in their low bits, so they're scrambled first.
+ */
+unsigned Shards::shard(const Timer* tm) const
+{
+    const auto p = reinterpret_cast<std::uintptr_t>(tm);
+    const std::uint64_t h = std::uint64_t{p} * 0x9e3779b97f4a7c15;
+    return (h >> 32) % shards.size();
+}
+
+bool Shards::add(unsigned i, Clock::time_point t, Timer* tm)
+{
+    return shards[i]->cc.add(t, tm);
+}
+
+bool Shards::remove(unsigned i, Timer* tm)
+{
+    return shards[i]->cc.remove(tm);
+}
+
+/**
+ * Like Clock::change(a, b, v), for all the shards at once. The shards
+ * are locked in order, so two change() calls can't deadlock.
+ */
+void Shards::change(Clock::time_point a, Clock::time_point b, double v)
+{
+    std::lock_guard<std::mutex> lock {mutex};
+    f = {f, b-a, v};
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shards.size());
+    for (auto& shard : shards) locks.emplace_back(shard->mutex);
+    for (auto& shard : shards) shard->clock.change(f);
+}
+
+Clock::Ramifications Shards::set(unsigned i, Clock::time_point t)
+{
+    Shard& shard = *shards[i];
+    std::lock_guard<std::mutex> lock {shard.mutex};
+    return shard.cc.set(t);
+}
+
+Clock::ref::duration Shards::set(unsigned i, Clock::time_point t,
+				 std::vector<Timer*>& elapsed)
+{
+    Shard& shard = *shards[i];
+    std::lock_guard<std::mutex> lock {shard.mutex};
+    return shard.cc.set(t, elapsed);
+}
+
+Clock::ref::duration Shards::dispatch(unsigned i, Clock::time_point t)
+{
+    Shard& shard = *shards[i];
+    std::lock_guard<std::mutex> lock {shard.mutex};
+    return shard.cc.dispatch(t);
+}
+
+/**
+ * Clock::at(t), which is the same for all the shards. Any thread.
+ */
+Clock::time_point Shards::at(Clock::ref::time_point t)
+{
+    std::lock_guard<std::mutex> lock {mutex};
+    return f(t);
+}
+
+/**
+ * Shard i's Clock, for next() and so on. Only for shard i's thread,
+ * not while a change() may be in progress, and it's not to be
+ * changed directly.
+ */
+Clock& Shards::clock(unsigned i)
+{
+    return shards[i]->clock;
+}
@@ -0,0 +1,76 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_SHARDS_H_
+#define SHOWTIME_SHARDS_H_
+
+#include "showtime.h"
+#include "concurrent.h"
+
+#include <mutex>
+
+namespace showtime {
+
+    /**
+     * A number of Clocks which share time, e.g. one per core. Each
+     * shard has its own schedule and is set by its own thread, so
+     * expiry runs in parallel.
+     *
+     * Timers go to a shard chosen by the caller, or by hashing the
+     * Timer's address; either way it must be removed from the same
+     * shard. Adding and removing is done as in a Concurrent, from
+     * any thread. Unless you give the schedules, each shard has a
+     * Wheel with the default tick.
+     *
+     * change() may also be called from any thread, and is atomic
+     * across the shards: it waits for any set() in progress, and
+     * changes every shard's clock before any of them is set again.
+     * For that, each shard has a mutex, which its set() holds; it's
+     * only contended during a change(). A shard which sleeps on a
+     * snooze time from before the change may need to be woken up.
+     * Not to be called from a timer's fire() in dispatch().
+     */
+    class Shards {
+    public:
+	explicit Shards(unsigned n);
+	explicit Shards(std::vector<std::unique_ptr<Schedule>> schedules);
+	Shards(const Shards&) = delete;
+	Shards& operator= (const Shards&) = delete;
+
+	unsigned size() const { return shards.size(); }
+	unsigned shard(const Timer* tm) const;
+
+	/* any thread */
+	bool add(Clock::time_point t, Timer* tm) { return add(shard(tm), t, tm); }
+	bool add(unsigned i, Clock::time_point t, Timer* tm);
+	bool remove(Timer* tm) { return remove(shard(tm), tm); }
+	bool remove(unsigned i, Timer* tm);
+	void change(Clock::time_point a, Clock::time_point b, double v);
+
+	/* shard i's thread */
+	Clock::Ramifications set(unsigned i, Clock::time_point t);
+	Clock::ref::duration set(unsigned i, Clock::time_point t,
+				 std::vector<Timer*>& elapsed);
+	Clock::ref::duration dispatch(unsigned i, Clock::time_point t);
+	Clock& clock(unsigned i);
+
+	/* any thread */
+	Clock::time_point at(Clock::ref::time_point t);
+
+    private:
+	struct Shard {
+	    explicit Shard(std::unique_ptr<Schedule> s)
+		: clock {std::move(s)},
+		  cc {clock}
+	    {}
+	    Clock clock;
+	    Concurrent cc;
+	    std::mutex mutex;
+	};
+	std::vector<std::unique_ptr<Shard>> shards;
+
+	std::mutex mutex;
+	Linear<Clock> f;
+    };
+}
+#endif
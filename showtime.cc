@@ -1,12 +1,122 @@
 #include "showtime.h"
+#include "map.h"
+
+#include <algorithm>
+#include <cmath>
 
 using showtime::Clock;
 using showtime::Timer;
+using showtime::Schedule;
+
+namespace {
+
+    /* 0 for 0, 1 for 1, 2 for 2-3 and so on, up to 31. */
+    unsigned bucket(unsigned long long n)
+    {
+	unsigned i = 0;
+	while (n && i < 31) {
+	    n >>= 1;
+	    i++;
+	}
+	return i;
+    }
+}
+
+/**
+ * The clock by default follows the reference clock, and keeps its
+ * timers in a Map.
+ */
+Clock::Clock()
+    : timers {new Map}
+{}
+
+Clock::Clock(std::unique_ptr<Schedule> timers)
+    : timers {std::move(timers)}
+{}
+
+Clock::~Clock() = default;
+
+Timer::~Timer()
+{
+    if (hook.s) hook.s->unlink(this);
+}
+
+/**
+ * Cancel the timer, and take it off its Schedule right away, so that
+ * it doesn't linger there, taking space and being skipped over.
+ *
+ * Setting 'cancelled' directly also works, but then the timer stays
+ * until it gets to the front, or until the Clock sweeps the cancelled
+ * timers out: when they're more than half of the schedule.
+ *
+ * Safe while processing the elapsed timers from Clock::set(): if the
+ * timer is listed again later, it's still marked as cancelled.
+ */
+void Timer::cancel()
+{
+    Schedule* const s = hook.s;
+    if (s && s->unlink(this)) s->removals++;
+    cancelled = true;
+}
+
+Timer::Flag& Timer::Flag::operator= (bool v)
+{
+    Schedule* const s = tm.hook.s;
+    if (s && v && !on) s->tombstones++;
+    if (s && !v && on) s->tombstones--;
+    on = v;
+    return *this;
+}
 
 /**
- * The clock by default follows the reference clock.
+ * The ratio num/den closest to v, for the speed of a Linear. Found
+ * using continued fractions, so simple ratios like 1/3 come out
+ * exact. The denominator stays below 2^31, and the numerator below
+ * 2^40 (a speed of about a trillion).
+ *
+ * NaN isn't a speed at all, and becomes 0: a stopped clock. An
+ * infinite speed becomes the largest one.
  */
-Clock::Clock() = default;
+void showtime::rational(double v, long long& num, long long& den)
+{
+    const double big = 1LL << 40;
+    const double max = 1LL << 31;
+    if (std::isnan(v)) {
+	num = 0;
+	den = 1;
+	return;
+    }
+    if (std::isinf(v)) {
+	num = v < 0 ? -big : big;
+	den = 1;
+	return;
+    }
+
+    const bool negative = v < 0;
+    if (negative) v = -v;
+
+    long long h0 = 0, h1 = 1;
+    long long k0 = 1, k1 = 0;
+    double x = v;
+    for (int i = 0; i < 64; i++) {
+	const double a = std::floor(x);
+	if (a*h1 + h0 > big || a*k1 + k0 > max) break;
+	const long long h2 = a*h1 + h0;
+	const long long k2 = a*k1 + k0;
+	h0 = h1; h1 = h2;
+	k0 = k1; k1 = k2;
+
+	if (x==a || std::fabs(double(h1)/k1 - v) <= v * 1e-16) break;
+	x = 1/(x - a);
+    }
+
+    if (!k1) {
+	h1 = big;
+	k1 = 1;
+    }
+    num = negative ? -h1 : h1;
+    den = k1;
+}
 
 /**
  * Change the clock so that what is time 'a' now becomes time 'b', and
@@ -27,73 +137,45 @@ void Clock::change(time_point a, time_point b, double v)
     f = {f, b-a, v};
 }
 
-namespace {
-    /* In a map, insert tm at t or as soon as possible after (in case
-     * t is already occupied).
-     */
-    void insert(std::map<Clock::time_point, Timer*>& m,
-		Clock::time_point t,
-		Timer* const tm)
-    {
-	while (m.count(t)) t += Clock::duration{1};
-	m.emplace(t, tm);
-    }
-
-    /* If 'e' is a repeating timer at a certain time, calculate all
-     * later times it will elapse, up to and including the first time
-     * after t, and collect them in a map.
-     */
-    template <class Entry>
-    void explode(std::map<Clock::time_point, Timer*>& m,
-		 const Clock::time_point t,
-		 const Entry& e)
-    {
-	Clock::time_point te = e.first;
-	Timer& tm = *e.second;
-	while (te < t) {
-	    te += tm.dt;
-	    insert(m, te, &tm);
-	}
-    }
-
-    /* Expand any non-cancelled, repeating timers in m before t, up
-     * until past t.
-     */
-    void repeat(std::map<Clock::time_point, Timer*>& m,
-		const Clock::time_point t)
-    {
-	std::map<Clock::time_point, Timer*> acc;
-
-	for (const auto& e : m) {
-	    if (e.first > t) break;
-	    if (e.second->repeat && !e.second->cancelled) {
-		explode(acc, t, e);
-	    }
-	}
-	m.insert(begin(acc), end(acc));
-    }
+/**
+ * Start (or stop) counting things in stats(). Starting again resets
+ * the counters.
+ */
+void Clock::instrument(bool on)
+{
+    counters.reset(on ? new Stats : nullptr);
+    removed0 = timers->removed();
+}
 
-    /* From a range in a map<t, Timer*>, return the timers in order.
-     * Skips cancelled timers (although this is probably unnecessary).
-     */
-    template <class It>
-    std::vector<Timer*> elapsed(It a, It b)
-    {
-	std::vector<Timer*> acc;
-	while (a!=b) {
-	    Timer* const tm = a->second;
-	    if (!tm->cancelled) acc.push_back(tm);
-	    a++;
-	}
-	return acc;
+/**
+ * A snapshot of the counters, or all zeros if the clock isn't
+ * instrumented. The schedule's size, and how many of its timers are
+ * cancelled but not yet dropped, are always there.
+ *
+ * Timers removed counts those actually taken off the schedule, by
+ * Clock::remove() or Timer::cancel().
+ */
+Clock::Stats Clock::stats() const
+{
+    Stats s;
+    if (counters) {
+	s = *counters;
+	s.removed = timers->removed() - removed0;
     }
+    s.size = timers->size();
+    s.cancelled = timers->cancelled();
+    return s;
 }
 
 /**
  * Move the clock to 't'. Oddly, this function, too, doesn't really
  * change time. It consumes and returns timers which elapsed before t,
  * schedules repeating timers, and tells the caller how long to wait
- * (in reference time) until the next timer ought to strike.
+ * (in reference time) until the next timer ought to strike. If the
+ * clock is stopped, that's forever: duration::max(). Then there's
+ * no need to call set() until the clock is changed again, since
+ * the time it shows doesn't change; if you do, it returns without
+ * looking at the schedule, since everything due by then is gone.
  *
  * - The elapsed set is sorted by time.
  * - Cancelled timers are absent (but more might be cancelled as a side
@@ -102,23 +184,190 @@ namespace {
  * - Repeating timers may be present multiple times. A once-a-day timer
  *   will be listed ~365 times if time moves forward a year.
  *   Unclear if this makes sense in practice!
+ * - Unless the clock coalesces. Then a repeating timer is listed once,
+ *   where it first elapsed, and its 'overrun' says how many more times
+ *   it elapsed. This takes constant time, however long the jump.
  * - Moving backwards doesn't make any timers elapse. There are no timers
  *   in the past, since timers are consumed by moving forward past them.
  *   There's not even any repeating timers.
+ *
+ * The cost is in the timers which elapse: each is taken off the
+ * Schedule and, if it repeats, put back once. Timers which don't
+ * elapse aren't looked at.
  */
 Clock::Ramifications Clock::set(time_point t)
 {
-    repeat(timers, t);
+    Ramifications r;
+    r.snooze = set(t, r.elapsed);
+    return r;
+}
+
+/**
+ * Like set(t), but appending the elapsed timers to a vector of your
+ * own, and returning just the snooze time. If you reuse the vector,
+ * whether this allocates is up to the Schedule. The Wheel and Heap
+ * don't, once they've grown. The Map's node for a repeating timer
+ * goes back to its Pool and comes right back out for the reinsert,
+ * so operator new isn't involved. Lists may allocate when a list
+ * empties and is recreated.
+ */
+Clock::ref::duration Clock::set(time_point t, std::vector<Timer*>& elapsed)
+{
+    expire(t, elapsed);
+    return snooze(t);
+}
 
-    auto it = timers.upper_bound(t);
-    while (it != end(timers) && it->second->cancelled) it++;
+/**
+ * Like set(t, elapsed), but taking at most max timers, so that the
+ * work per call is bounded. The rest stay scheduled, in order, for
+ * the next call. A snooze time of zero means there are more timers
+ * due by t (cancelled ones don't count); otherwise it's the usual
+ * one. A max of 0 is taken as 1, or a loop on the snooze time would
+ * never get anywhere.
+ */
+Clock::ref::duration Clock::set(time_point t, std::vector<Timer*>& elapsed,
+				std::size_t max)
+{
+    expire(t, elapsed, max);
+    return rest(t);
+}
 
-    Clock::duration snooze = std::chrono::hours{1};
-    if (it != end(timers)) snooze = it->first - t;
+/**
+ * Like set(t, elapsed), but returning the deadline() rather than a
+ * snooze time: for sleep_until(), or an absolute timerfd.
+ */
+Clock::ref::time_point Clock::set_until(time_point t, std::vector<Timer*>& elapsed)
+{
+    expire(t, elapsed);
+    return deadline();
+}
 
-    Ramifications r { elapsed(begin(timers), it), f(snooze)};
-    timers.erase(begin(timers), it);
-    return r;
+/**
+ * Like set(t), but rather than listing the elapsed timers, call
+ * their fire() one by one, in time order. Returns the snooze time.
+ *
+ * A timer which is cancelled or removed by an earlier one doesn't
+ * fire. A repeating timer is rescheduled before it fires, so fire()
+ * can cancel it or re-arm it. Timers added during the dispatch
+ * which are due by t fire too, before it returns.
+ */
+Clock::ref::duration Clock::dispatch(time_point t)
+{
+    for (Timer* tm : Elapsing {*this, t}) tm->fire();
+    return snooze(t);
+}
+
+/**
+ * Like dispatch(t), but firing at most max timers; the snooze time is
+ * zero if there are more due by t. See set(t, elapsed, max).
+ */
+Clock::ref::duration Clock::dispatch(time_point t, std::size_t max)
+{
+    for (Timer* tm : Elapsing {*this, t, max}) tm->fire();
+    return rest(t);
+}
+
+/* The work of set(t): consuming timers up to t, and rescheduling
+ * repeating ones. Once that's done, nothing is due by t until more
+ * timers are added, so setting the clock to t or earlier again (like
+ * a paused clock does) is left at that.
+ */
+void Clock::expire(time_point t, std::vector<Timer*>& elapsed,
+		   std::size_t max)
+{
+    for (Timer* tm : Elapsing {*this, t, max}) elapsed.push_back(tm);
+}
+
+Clock::Elapsing::Elapsing(Clock& clock, time_point t, std::size_t max)
+    : clock {&clock},
+      t {t},
+      max {max ? max : 1},
+      t0 {clock.counters ? std::chrono::steady_clock::now()
+			 : std::chrono::steady_clock::time_point {}}
+{}
+
+Clock::Elapsing::Elapsing(Elapsing&& other)
+    : clock {other.clock},
+      t {other.t},
+      max {other.max},
+      n {other.n},
+      t0 {other.t0}
+{
+    other.clock = nullptr;
+}
+
+Clock::Elapsing::~Elapsing()
+{
+    if (clock && clock->counters) clock->record(t0, n);
+}
+
+/**
+ * The first timer due, unless the clock has already been set to t or
+ * later, with nothing added since; then there are none.
+ */
+Clock::Elapsing::iterator Clock::Elapsing::begin()
+{
+    iterator it {this};
+    if (t <= clock->settled) return it;
+    clock->sweep();
+    it.tm = next();
+    return it;
+}
+
+/* The next timer due, or nullptr. Running out (rather than reaching
+ * max) means the clock is settled at t.
+ */
+showtime::Timer* Clock::Elapsing::next()
+{
+    if (n==max) return nullptr;
+    Timer* tm;
+    if (!clock->take(t, tm)) {
+	clock->settled = t;
+	return nullptr;
+    }
+    n++;
+    return tm;
+}
+
+/* Count a set() which started at t0 and found n timers.
+ */
+void Clock::record(std::chrono::steady_clock::time_point t0, std::size_t n)
+{
+    const auto dt = std::chrono::steady_clock::now() - t0;
+    counters->sets++;
+    counters->batch[bucket(n)]++;
+    counters->latency[bucket(std::chrono::nanoseconds{dt}.count())]++;
+}
+
+/* Take the first timer due by t, skipping cancelled ones, and
+ * reschedule it if it repeats.
+ */
+bool Clock::take(time_point t, Timer*& tm)
+{
+    Schedule::Entry e;
+    for (;;) {
+	if (!timers->pop(t, e)) return false;
+	if (!e.tm->cancelled) break;
+	timers->tombstones--;
+	if (counters) counters->skipped++;
+    }
+
+    tm = e.tm;
+    tm->overrun = 0;
+    if (counters) counters->elapsed++;
+    if (!tm->repeat || tm->dt <= duration{0}) return true;
+
+    time_point next = e.t + tm->dt;
+    if (coalescing && next <= t) {
+	tm->overrun = (t - e.t) / tm->dt;
+	next = e.t + (tm->overrun + 1) * tm->dt;
+    }
+    timers->insert(next, tm);
+    if (counters) {
+	counters->repeated++;
+	counters->overrun += tm->overrun;
+    }
+    return true;
 }
 
 /**
@@ -129,34 +378,269 @@ Clock::time_point Clock::at(Clock::ref::time_point ref) const
     return f(ref);
 }
 
+/**
+ * Translating an array [a, b) of reference times, into 'out'. Much
+ * faster than one by one, at least at normal and integral speeds.
+ */
+void Clock::at(const ref::time_point* a, const ref::time_point* b,
+	       time_point* out) const
+{
+    f(a, b, out);
+}
+
+/**
+ * Translating clock time back to reference time: when the clock
+ * shows t. Rounded up, and max() if the clock is stopped or going
+ * backwards, so that it never shows t.
+ */
+Clock::ref::time_point Clock::when(time_point t) const
+{
+    return f.inverse(t);
+}
+
+/**
+ * Like when(t), for each t in [a, b).
+ */
+void Clock::when(const time_point* a, const time_point* b,
+		 ref::time_point* out) const
+{
+    f.inverse(a, b, out);
+}
+
 /**
  * Assuming time is now t, add a timer. Timers are expressed in terms
  * of a duration, so a 30 min timer added at 10:00 will elapse at
  * 10:30. Timers can also repeat; if that timer did, it would elapse
  * at 10:30, 11:00, 11:30 and so on, unless cancelled.
  *
- * The Clock doesn't own these Timers. They can be added multiple
- * times; if you see a reason to do so, please do.
+ * The Clock doesn't own these Timers. Adding a Timer which is
+ * already scheduled re-arms it: it's moved to its new time.
  *
  * Returns a "snooze time" just like set(t) does, since the new timer
  * may elapse before any already scheduled.
  */
 Clock::ref::duration Clock::add(Clock::time_point t, Timer* tm)
 {
-    t += tm->dt;
-    insert(timers, t, tm);
+    timers->place(t + tm->dt, tm);
+    settled = time_point::min();
+    if (counters) counters->added++;
+    sweep();
+    return snooze(t);
+}
+
+/**
+ * Add a batch of timers, like add(t, tm) for each one but faster:
+ * the batch is sorted once, and the Schedule gets to insert it as a
+ * whole. Timers with the same deadline keep their order in the
+ * batch.
+ */
+Clock::ref::duration Clock::add(Clock::time_point t,
+				const std::vector<Timer*>& batch)
+{
+    std::vector<Schedule::Entry> v;
+    v.reserve(batch.size());
+    for (Timer* tm : batch) v.push_back({t + tm->dt, tm});
 
-    const auto head = *timers.begin();
-    return f(head.first - t);
+    std::stable_sort(begin(v), end(v),
+		     [] (const Schedule::Entry& a, const Schedule::Entry& b) {
+			 return a.t < b.t;
+		     });
+    timers->place(v.data(), v.data() + v.size());
+    settled = time_point::min();
+    if (counters) counters->added += v.size();
+    sweep();
+    return snooze(t);
 }
 
 /**
- * Remove a timer (from all its occurences on the schedule). Not quite
- * the same thing as cancelling it.
+ * Remove a timer from the schedule, if it's there. Not quite the
+ * same thing as cancelling it, but cheap: O(1) or O(log n) depending
+ * on the Schedule.
  */
 void Clock::remove(Timer* tm)
 {
-    for (auto& kv : timers) {
-	if (kv.second==tm) kv.second = nullptr;
+    if (timers->unlink(tm)) timers->removals++;
+}
+
+/**
+ * Append the scheduled timers to v, in the order they elapse (unless
+ * the clock jumps back). Cancelled timers which haven't been dropped
+ * yet are there too.
+ */
+void Clock::list(std::vector<Entry>& v) const
+{
+    timers->list(v);
+}
+
+/**
+ * Schedule a batch of timers, sorted by time, each at its own time
+ * rather than at t + dt like add(). For restoring what list() gave,
+ * e.g. from a Snapshot. Timers at the same time keep their order.
+ */
+void Clock::insert(Entry* a, Entry* b)
+{
+    timers->place(a, b);
+    settled = time_point::min();
+    if (counters) counters->added += b - a;
+    sweep();
+}
+
+/* Drop the cancelled timers which linger on the schedule, once
+ * they're more than half of it: each sweep is O(n), but it takes
+ * n/2 cancellations to make another one necessary. Checked whenever
+ * timers are added, and before they're expired.
+ */
+void Clock::sweep()
+{
+    const std::size_t n = timers->cancelled();
+    if (n < 64 || 2*n <= timers->size()) return;
+
+    timers->purge();
+    if (counters) counters->swept += n;
+}
+
+/**
+ * The time of the first timer to strike, or false if there are none.
+ * Cancelled timers at the front of the schedule are dropped on the
+ * way.
+ */
+bool Clock::next(time_point& t)
+{
+    Schedule::Entry e;
+    const Schedule::Entry* head = timers->front();
+    while (head && head->tm->cancelled) {
+	timers->pop(head->t, e);
+	timers->tombstones--;
+	head = timers->front();
+	if (counters) counters->skipped++;
+    }
+
+    if (!head) return false;
+    t = head->t;
+    return true;
+}
+
+/**
+ * The reference time when the first timer strikes, or max() if there
+ * are no timers, or if the clock is stopped so that they never
+ * strike. Unlike the snooze time this doesn't depend on when you ask,
+ * so it's what you want for sleeping until an absolute time.
+ *
+ * With some slack, like Linux timer slack, it's up to that much
+ * later: the wakeup is rounded up to a multiple of the slack, so
+ * that timers close to each other strike together, and the caller
+ * wakes up less often. Timers are never early.
+ */
+Clock::ref::time_point Clock::deadline()
+{
+    if (paused()) return ref::time_point::max();
+    time_point te;
+    if (!first(te)) return ref::time_point::max();
+    return f.inverse(te);
+}
+
+/* The first timer, like next(t), but rounded up to the slack (see
+ * deadline()).
+ */
+bool Clock::first(time_point& t)
+{
+    if (!next(t)) return false;
+    if (tolerance > duration{0}) {
+	const auto r = t.time_since_epoch() % tolerance;
+	if (r > duration{0}) t += tolerance - r;
+	if (r < duration{0}) t -= r;
+    }
+    return true;
+}
+
+/* How long to wait (in reference time) from t until the first timer
+ * strikes: the clock time until then, divided by the speed. An hour
+ * if there are no timers, and max() if the clock is stopped; then
+ * the schedule isn't even looked at.
+ */
+Clock::ref::duration Clock::snooze(time_point t)
+{
+    if (paused()) return ref::duration::max();
+    time_point te;
+    if (!first(te)) return std::chrono::hours{1};
+    return f.inverse(te - t);
+}
+
+/* The snooze time after a bounded set(): zero if there's more due by
+ * t, whether the clock is stopped or not. Cancelled timers in the way
+ * are dropped first, by next(), so they don't count.
+ */
+Clock::ref::duration Clock::rest(time_point t)
+{
+    time_point te;
+    if (t > settled && next(te) && te <= t) return ref::duration {0};
+    return snooze(t);
+}
+
+/**
+ * Insert a timer, taking it off any other Schedule, and counting it
+ * if it's cancelled.
+ */
+void Schedule::place(time_point t, Timer* tm)
+{
+    if (tm->cancelled) {
+	if (tm->hook.s) tm->hook.s->unlink(tm);
+	tombstones++;
+    }
+    insert(t, tm);
+}
+
+/**
+ * Like place(t, tm) for a batch, sorted by time.
+ */
+void Schedule::place(Entry* a, Entry* b)
+{
+    for (Entry* e = a; e != b; e++) {
+	Timer* const tm = e->tm;
+	if (!tm->cancelled) continue;
+	if (tm->hook.s) tm->hook.s->unlink(tm);
+	tombstones++;
+    }
+    insert(a, b);
+}
+
+/**
+ * Remove a timer, if it's on this schedule, keeping count of the
+ * cancelled ones. True if it was there.
+ */
+bool Schedule::unlink(Timer* tm)
+{
+    if (tm->hook.s != this) return false;
+    if (tm->cancelled) tombstones--;
+    remove(tm);
+    return true;
+}
+
+/**
+ * Remove all the cancelled timers, and return how many there were.
+ */
+std::size_t Schedule::purge()
+{
+    const std::size_t n = tombstones;
+    if (n) compact();
+    tombstones = 0;
+    return n;
+}
+
+void Schedule::insert(Entry* a, Entry* b)
+{
+    while (a != b) {
+	insert(a->t, a->tm);
+	a++;
+    }
+}
+
+void Schedule::compact()
+{
+    std::vector<Entry> v;
+    v.reserve(size());
+    list(v);
+    for (const Entry& e : v) {
+	if (e.tm->cancelled) remove(e.tm);
     }
 }
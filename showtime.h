@@ -11,53 +11,234 @@
 #ifndef SHOWTIME_SHOWTIME_H_
 #define SHOWTIME_SHOWTIME_H_
 
+#include <atomic>
 #include <chrono>
+#include <ratio>
+#include <limits>
+#include <type_traits>
 #include <vector>
-#include <map>
+#include <memory>
 
 namespace showtime {
 
     class Timer;
+    class Schedule;
+    class Concurrent;
+
+    namespace detail {
+
+	/* The arithmetic shared by the Linear specializations below.
+	 */
+	__extension__ typedef __int128 wide;
+
+	constexpr wide ceil(wide a, wide b) {
+	    return a/b + (a%b > 0);
+	}
+
+	template <class Rep>
+	constexpr Rep narrow(wide a) {
+	    return a > std::numeric_limits<Rep>::max() ? std::numeric_limits<Rep>::max()
+		 : a < std::numeric_limits<Rep>::min() ? std::numeric_limits<Rep>::min()
+		 : static_cast<Rep>(a);
+	}
+    }
 
     /* f(x) = kx + m
      * A linear function of time.
      *
-     * It's a bit unsatisfactory that the speed is floating-point,
-     * because of the floating-point errors.
+     * The speed k is a ratio of integers, so that the common speeds
+     * (0, 1, 2, 1/2 and so on) are exact and cheap; the intermediate
+     * results are 128 bits, since nanoseconds since the epoch times k
+     * won't fit in 64.
+     *
+     * The inverse, from f(x) back to x, rounds up, so that waiting
+     * until inverse(y) never means waiting too little. For a clock
+     * which is stopped or going backwards there is no such x, and
+     * the inverse is max().
+     *
+     * Normally k is chosen at runtime, but see below.
      */
-    template <class Clock>
+    template <class Clock, class Rate = void>
     class Linear {
+	static_assert(std::is_void<Rate>::value,
+		      "a Linear's Rate is a std::ratio, or void for a runtime speed");
     public:
 	using time_point = typename Clock::time_point;
 	using duration = typename Clock::duration;
-	using ddur = std::chrono::duration<double, typename duration::period>;
+	using rep = typename duration::rep;
 
-	Linear() = default;
+	constexpr Linear() = default;
 	Linear(const Linear&, duration dt, double v);
+	constexpr Linear(const Linear& other, duration dt, rep num, rep den)
+	    : num {num},
+	      den {den},
+	      m {other.m + dt}
+	{}
+
+	constexpr time_point operator() (time_point x) const {
+	    return time_point {(*this)(x.time_since_epoch()) + m};
+	}
+
+	constexpr duration operator() (duration dt) const {
+	    if (den==1) {
+		if (num==1) return dt;
+		return duration {static_cast<rep>(wide {dt.count()} * num)};
+	    }
+	    return duration {static_cast<rep>(wide {dt.count()} * num / den)};
+	}
 
-	time_point operator() (time_point x) const {
-	    double t = x.time_since_epoch().count();
-	    ddur dt {k*t};
-	    duration tt = std::chrono::duration_cast<duration>(dt + m);
-	    return time_point {tt};
+	void operator() (const time_point* a, const time_point* b,
+			 time_point* out) const;
+
+	constexpr time_point inverse(time_point y) const {
+	    if (num <= 0) return time_point::max();
+	    return time_point {inverse(y.time_since_epoch() - m)};
 	}
 
-	duration operator() (duration dt) const {
-	    double t = dt.count();
-	    ddur tt {k*t};
-	    return std::chrono::duration_cast<duration>(tt);
+	constexpr duration inverse(duration dt) const {
+	    if (num <= 0) return duration::max();
+	    if (den==1 && num==1) return dt;
+	    return duration {detail::narrow<rep>(detail::ceil(wide {dt.count()} * den,
+							  num))};
 	}
 
+	void inverse(const time_point* a, const time_point* b,
+		     time_point* out) const;
+
+	constexpr bool stopped() const { return num==0; }
+
+	constexpr rep numerator() const { return num; }
+	constexpr rep denominator() const { return den; }
+	constexpr duration offset() const { return m; }
+
     private:
-	double k = 1;
+	using wide = detail::wide;
+
+	rep num = 1;
+	rep den = 1;
 	duration m {0};
     };
 
+    void rational(double v, long long& num, long long& den);
+
+    template <class Clock, class Rate>
+    Linear<Clock, Rate>::Linear(const Linear& other, duration dt, double v)
+	: m {other.m + dt}
+    {
+	long long a, b;
+	rational(v, a, b);
+	num = a;
+	den = b;
+    }
+
+    /* f(x) for all x in [a, b), into out. Written for the vectorizer:
+     * with an integral speed, it's a multiplication and an addition
+     * which wrap around, but that only matters if the result doesn't
+     * fit in a time_point anyway. Other speeds are done one by one.
+     */
+    template <class Clock, class Rate>
+    void Linear<Clock, Rate>::operator() (const time_point* a, const time_point* b,
+					  time_point* out) const
+    {
+	using u = typename std::make_unsigned<rep>::type;
+	const std::size_t n = b - a;
+	const u mm = m.count();
+
+	if (den==1 && num==1) {
+	    for (std::size_t i = 0; i < n; i++) {
+		const u t = a[i].time_since_epoch().count();
+		out[i] = time_point {duration {static_cast<rep>(t + mm)}};
+	    }
+	}
+	else if (den==1) {
+	    const u k = num;
+	    for (std::size_t i = 0; i < n; i++) {
+		const u t = a[i].time_since_epoch().count();
+		out[i] = time_point {duration {static_cast<rep>(t*k + mm)}};
+	    }
+	}
+	else {
+	    for (std::size_t i = 0; i < n; i++) out[i] = (*this)(a[i]);
+	}
+    }
+
+    /* The inverse for all y in [a, b), into out.
+     */
+    template <class Clock, class Rate>
+    void Linear<Clock, Rate>::inverse(const time_point* a, const time_point* b,
+				      time_point* out) const
+    {
+	using u = typename std::make_unsigned<rep>::type;
+	const std::size_t n = b - a;
+	const u mm = m.count();
+
+	if (den==1 && num==1) {
+	    for (std::size_t i = 0; i < n; i++) {
+		const u t = a[i].time_since_epoch().count();
+		out[i] = time_point {duration {static_cast<rep>(t - mm)}};
+	    }
+	}
+	else {
+	    for (std::size_t i = 0; i < n; i++) out[i] = inverse(a[i]);
+	}
+    }
+
+    /* f(x) = kx + m, with k fixed at compile time as a std::ratio.
+     * Everything is constexpr, so where the mapping is known it folds
+     * away, and when k is 1 a conversion is a single addition.
+     *
+     * This is a standalone helper, for converting on your side of
+     * the Clock: the Clock itself has a runtime speed (it can be
+     * changed) and always uses Linear<Clock>, so at(), deadline()
+     * and the snooze time don't get any faster from this. They do
+     * test for a speed of 1 first, though.
+     */
+    template <class Clock, std::intmax_t N, std::intmax_t D>
+    class Linear<Clock, std::ratio<N, D>> {
+    public:
+	using time_point = typename Clock::time_point;
+	using duration = typename Clock::duration;
+	using rep = typename duration::rep;
+	using rate = std::ratio<N, D>;
+
+	constexpr Linear() = default;
+	constexpr explicit Linear(duration m) : m {m} {}
+	constexpr Linear(const Linear& other, duration dt) : m {other.m + dt} {}
+
+	constexpr time_point operator() (time_point x) const {
+	    return time_point {(*this)(x.time_since_epoch()) + m};
+	}
+
+	constexpr duration operator() (duration dt) const {
+	    if (rate::num==rate::den) return dt;
+	    return duration {static_cast<rep>(wide {dt.count()} * rate::num / rate::den)};
+	}
+
+	constexpr time_point inverse(time_point y) const {
+	    if (rate::num <= 0) return time_point::max();
+	    return time_point {inverse(y.time_since_epoch() - m)};
+	}
+
+	constexpr duration inverse(duration dt) const {
+	    if (rate::num <= 0) return duration::max();
+	    if (rate::num==rate::den) return dt;
+	    return duration {detail::narrow<rep>(detail::ceil(wide {dt.count()} * rate::den,
+							  rate::num))};
+	}
+
+	constexpr bool stopped() const { return rate::num==0; }
+
+    private:
+	using wide = detail::wide;
+
+	duration m {0};
+    };
+
+    /* A mapping which is just an offset. Standalone too, like the
+     * above.
+     */
     template <class Clock>
-    Linear<Clock>::Linear(const Linear<Clock>& other, duration dt, double v)
-	: k {v},
-	  m {other.m + dt}
-    {}
+    using Offset = Linear<Clock, std::ratio<1>>;
 
     /**
      * A clock on top of std::chrono::system_clock (the reference
@@ -76,6 +257,9 @@ namespace showtime {
      * In fact, it doesn't interact with any OS-level clock, or timer
      * system for that matter. You have to add that on top of this
      * class.
+     *
+     * The timers are kept in a Schedule, by default a Map. Other
+     * kinds can be chosen at construction.
      */
     class Clock {
     public:
@@ -87,9 +271,19 @@ namespace showtime {
 	using time_point = ref::time_point;
 
 	Clock();
+	explicit Clock(std::unique_ptr<Schedule> timers);
+	~Clock();
 	Clock(const Clock&) = delete;
 	Clock& operator= (const Clock&) = delete;
 
+	/**
+	 * A timer, and when it's scheduled. See list().
+	 */
+	struct Entry {
+	    time_point t;
+	    Timer* tm;
+	};
+
 	/**
 	 * See set(t).
 	 */
@@ -99,31 +293,268 @@ namespace showtime {
 	};
 
 	void change(time_point a, time_point b, double v);
+	void change(const Linear<Clock>& g) { f = g; }
+	const Linear<Clock>& mapping() const { return f; }
+	bool paused() const { return f.stopped(); }
+	void coalesce(bool on) { coalescing = on; }
+	void slack(duration dt) { tolerance = dt; }
+
+	/**
+	 * Counters, for watching what the Clock does. Off by default,
+	 * and then they cost nothing but a test of a null pointer.
+	 */
+	struct Stats {
+	    unsigned long added = 0;
+	    unsigned long removed = 0;
+	    unsigned long sets = 0;
+	    unsigned long elapsed = 0;
+	    unsigned long repeated = 0;
+	    unsigned long overrun = 0;
+	    unsigned long skipped = 0;	/* cancelled timers dropped as met */
+	    unsigned long swept = 0;	/* ... and in bulk, by compacting */
+	    std::size_t size = 0;	/* timers now on the schedule */
+	    std::size_t cancelled = 0;	/* ... of which cancelled */
+
+	    /* set() calls by timers elapsed: 0, 1, 2-3, 4-7 ... */
+	    unsigned long batch[32] = {};
+	    /* set() calls by how long they took, in ns: 0, 1, 2-3 ... */
+	    unsigned long latency[32] = {};
+	};
+	void instrument(bool on);
+	Stats stats() const;
 	Ramifications set(time_point t);
+	ref::duration set(time_point t, std::vector<Timer*>& elapsed);
+	ref::duration set(time_point t, std::vector<Timer*>& elapsed,
+			  std::size_t max);
+	ref::time_point set_until(time_point t, std::vector<Timer*>& elapsed);
+	ref::duration dispatch(time_point t);
+	ref::duration dispatch(time_point t, std::size_t max);
+
+	/**
+	 * The timers elapsing up to t, as a range: like set(t), but
+	 * taken off the schedule one at a time, as you iterate. What
+	 * you don't get to stays scheduled, in order. It counts in
+	 * stats() as one set(), once the range is destroyed.
+	 */
+	class Elapsing {
+	public:
+	    class iterator {
+	    public:
+		Timer* operator* () const { return tm; }
+		iterator& operator++ () { tm = r->next(); return *this; }
+		bool operator== (const iterator& other) const { return tm==other.tm; }
+		bool operator!= (const iterator& other) const { return tm!=other.tm; }
+
+	    private:
+		friend class Elapsing;
+		explicit iterator(Elapsing* r) : r {r} {}
+		Elapsing* r;
+		Timer* tm = nullptr;
+	    };
+
+	    Elapsing(Elapsing&& other);
+	    Elapsing(const Elapsing&) = delete;
+	    Elapsing& operator= (const Elapsing&) = delete;
+	    ~Elapsing();
+
+	    iterator begin();
+	    iterator end() { return iterator {this}; }
+
+	private:
+	    friend class Clock;
+	    Elapsing(Clock& clock, time_point t,
+		     std::size_t max = std::size_t(-1));
+	    Timer* next();
+
+	    Clock* clock;
+	    time_point t;
+	    std::size_t max;
+	    std::size_t n = 0;
+	    std::chrono::steady_clock::time_point t0;
+	};
+
+	Elapsing elapsing(time_point t) { return {*this, t}; }
 
 	time_point at(ref::time_point ref) const;
+	void at(const ref::time_point* a, const ref::time_point* b,
+		time_point* out) const;
+	ref::time_point when(time_point t) const;
+	void when(const time_point* a, const time_point* b,
+		  ref::time_point* out) const;
+	bool next(time_point& t);
+	ref::time_point deadline();
 
 	ref::duration add(time_point t, Timer* tm);
+	ref::duration add(time_point t, const std::vector<Timer*>& batch);
+	template <class It>
+	ref::duration add(time_point t, It a, It b) {
+	    return add(t, std::vector<Timer*>(a, b));
+	}
 	void remove(Timer* tm);
 
+	void list(std::vector<Entry>& v) const;
+	void insert(Entry* a, Entry* b);
+
     private:
 	Linear<Clock> f;
-	std::map<time_point, Timer*> timers;
+	std::unique_ptr<Schedule> timers;
+	bool coalescing = false;
+	duration tolerance {0};
+	std::unique_ptr<Stats> counters;
+	unsigned long removed0 = 0;
+	/* Nothing is due by this time, unless timers have been added
+	 * since; see expire().
+	 */
+	time_point settled = time_point::min();
+
+	void sweep();
+	void expire(time_point t, std::vector<Timer*>& elapsed,
+		    std::size_t max = std::size_t(-1));
+	ref::duration rest(time_point t);
+	bool take(time_point t, Timer*& tm);
+	void record(std::chrono::steady_clock::time_point t0, std::size_t n);
+	bool first(time_point& t);
+	ref::duration snooze(time_point t);
     };
 
     /**
      * A Timer base class. Supports optional repetition, and
      * cancellation. Not to be copied: the address is its identity.
+     *
+     * A Timer is on at most one Schedule at a time, and removes
+     * itself from it when destroyed.
      */
     class Timer {
     public:
 	Timer(Clock::duration dt, bool repeat = false) : dt{dt}, repeat{repeat} {}
-	virtual ~Timer() = default;
+	virtual ~Timer();
 	Timer(const Timer&) = delete;
 
 	const Clock::duration dt;
 	const bool repeat;
-	bool cancelled = false;
+
+	/**
+	 * Whether the timer is cancelled. Works like a bool, but a
+	 * Schedule keeps count of its cancelled timers, so that the
+	 * Clock knows when to sweep them out.
+	 */
+	class Flag {
+	public:
+	    explicit Flag(Timer& tm) : tm(tm) {}
+	    Flag(const Flag&) = delete;
+	    operator bool() const { return on; }
+	    Flag& operator= (bool v);
+	private:
+	    Timer& tm;
+	    bool on = false;
+	};
+	Flag cancelled {*this};
+	void cancel();
+
+	/* What Clock::dispatch() does when the timer elapses. */
+	virtual void fire() {}
+
+	/* Times it elapsed without being listed (see Clock::set()). */
+	unsigned long overrun = 0;
+
+	/**
+	 * Where on its Schedule the Timer is, if anywhere. The details
+	 * are up to the Schedule, but by convention
+	 *
+	 * - s: the Schedule, or nullptr
+	 * - t: the time it's scheduled at
+	 * - n: its index in a container, or the sequence number it's
+	 *   keyed by
+	 * - where: which of the Schedule's containers it's in, or its
+	 *   index when n is taken by the sequence number
+	 * - p: a pointer to a container, if there are many
+	 */
+	struct Hook {
+	    Schedule* s = nullptr;
+	    Clock::time_point t;
+	    std::size_t n;
+	    std::size_t where;
+	    void* p;
+	};
+
+    private:
+	friend class Schedule;
+	friend class Concurrent;
+	Hook hook;
+
+	/* A request from another thread, pending on a Concurrent:
+	 * the time to add the timer at, or one of the two values
+	 * below. Embedded, so that making one doesn't allocate; the
+	 * price is that every Timer is 16 bytes bigger, whether it's
+	 * ever used with a Concurrent or not.
+	 */
+	struct Request {
+	    static constexpr Clock::rep none = std::numeric_limits<Clock::rep>::min();
+	    static constexpr Clock::rep removal = none + 1;
+	    std::atomic<Clock::rep> t {none};
+	    Timer* next = nullptr;
+	};
+	Request request;
+    };
+
+    /**
+     * Where a Clock keeps its timers, in time order. Timers at the
+     * same time are kept in the order they were inserted.
+     *
+     * The Clock does the rest: skipping cancelled timers, repeating
+     * timers and so on. A Schedule just needs to
+     *
+     * - insert(t, tm): add a timer at t
+     * - insert(a, b): add a batch of timers, sorted by time; by
+     *   default one by one
+     * - front(): return the first entry, or nullptr if there are none
+     * - pop(t, e): remove the first entry into e, unless it's later than t
+     * - remove(tm): remove the timer, if it's on this schedule
+     * - size(): the number of timers
+     * - list(v): append all entries to v, in order
+     * - compact(): remove all the cancelled timers; by default using
+     *   list() and remove(), but it's better done in place
+     *
+     * Inserting a timer which is already on a schedule moves it.
+     * The Schedule keeps track of its timers using their Hook, so
+     * that removing one doesn't mean searching for it.
+     *
+     * The Clock inserts and removes using place() and unlink(), and
+     * compacts using purge(), which also keep count of the cancelled
+     * timers on the schedule.
+     */
+    class Schedule {
+    public:
+	using time_point = Clock::time_point;
+
+	using Entry = Clock::Entry;
+
+	virtual ~Schedule() = default;
+
+	virtual void insert(time_point t, Timer* tm) = 0;
+	virtual void insert(Entry* a, Entry* b);
+	virtual const Entry* front() = 0;
+	virtual bool pop(time_point t, Entry& e) = 0;
+	virtual void remove(Timer* tm) = 0;
+	virtual std::size_t size() const = 0;
+	virtual void list(std::vector<Entry>& v) const = 0;
+
+	void place(time_point t, Timer* tm);
+	void place(Entry* a, Entry* b);
+	bool unlink(Timer* tm);
+	std::size_t purge();
+	std::size_t cancelled() const { return tombstones; }
+	unsigned long removed() const { return removals; }
+
+    protected:
+	static Timer::Hook& hook(Timer* tm) { return tm->hook; }
+	virtual void compact();
+
+    private:
+	friend class Timer;
+	friend class Clock;
+	std::size_t tombstones = 0;
+	unsigned long removals = 0;
     };
 }
 #endif
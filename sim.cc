@@ -0,0 +1,61 @@
+#include "sim.h"
+
+using showtime::Sim;
+
+/**
+ * Jump to the clock's next deadline and set it there, calling f with
+ * the time and the elapsed timers. If the deadline is after 'end', or
+ * there is none, jump to 'end' instead and return false.
+ *
+ * The elapsed vector is reused, and only valid during the call.
+ */
+bool Sim::step(ref::time_point end, const Step& f)
+{
+    if (!advance(end)) return false;
+    elapsed.clear();
+    clock.set(clock.at(t), elapsed);
+    f(t, elapsed);
+    return true;
+}
+
+/**
+ * Step until 'end', and return the number of steps. The clock has
+ * then been set at every deadline up to and including 'end', and
+ * now() is 'end'. The clock isn't set at 'end' itself, unless a
+ * deadline falls there; nothing would elapse anyway.
+ */
+unsigned long Sim::run(ref::time_point end, const Step& f)
+{
+    unsigned long n = 0;
+    while (step(end, f)) n++;
+    return n;
+}
+
+/**
+ * Like run(end, f), but with Clock::dispatch() at each deadline:
+ * the timers' fire() is the step.
+ */
+unsigned long Sim::dispatch(ref::time_point end)
+{
+    unsigned long n = 0;
+    while (advance(end)) {
+	clock.dispatch(clock.at(t));
+	n++;
+    }
+    return n;
+}
+
+/* Move to the next deadline, if it's no later than 'end', or else to
+ * 'end'. The deadline is never before now(): timers which were due
+ * already strike now. Without timers there's no deadline at all.
+ */
+bool Sim::advance(ref::time_point end)
+{
+    const auto te = clock.deadline();
+    if (te > end || te == ref::time_point::max()) {
+	if (t < end) t = end;
+	return false;
+    }
+    if (te > t) t = te;
+    return true;
+}
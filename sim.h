@@ -0,0 +1,48 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_SIM_H_
+#define SHOWTIME_SIM_H_
+
+#include "showtime.h"
+
+#include <functional>
+#include <vector>
+
+namespace showtime {
+
+    /**
+     * Simulated reference time, for driving a Clock in tests: rather
+     * than sleeping for the snooze time, jump straight to the next
+     * deadline and set the clock there. Nothing ever waits, so a day
+     * of timers takes as long as the timers themselves.
+     *
+     * The Sim doesn't own the clock, and keeps no state but the
+     * time; timers can be added (at now()) and the clock changed
+     * between steps, or from inside them.
+     */
+    class Sim {
+    public:
+	using ref = Clock::ref;
+	using Step = std::function<void (ref::time_point now,
+					 const std::vector<Timer*>& elapsed)>;
+
+	Sim(Clock& clock, ref::time_point now) : clock(clock), t(now) {}
+	Sim(const Sim&) = delete;
+	Sim& operator= (const Sim&) = delete;
+
+	ref::time_point now() const { return t; }
+
+	bool step(ref::time_point end, const Step& f);
+	unsigned long run(ref::time_point end, const Step& f);
+	unsigned long dispatch(ref::time_point end);
+
+    private:
+	Clock& clock;
+	ref::time_point t;
+	std::vector<Timer*> elapsed;
+
+	bool advance(ref::time_point end);
+    };
+}
+#endif
@@ -0,0 +1,183 @@
+#include "slab.h"
+
+#include <algorithm>
+
+using showtime::Slab;
+
+void Slab::change(time_point a, time_point b, double v)
+{
+    f = {f, b-a, v};
+}
+
+/**
+ * Assuming time is now t, add a timer which elapses after dt, and
+ * then every dt if it repeats.
+ */
+Slab::Id Slab::add(time_point t, duration dt, bool repeat)
+{
+    std::uint32_t i;
+    if (free.empty()) {
+	i = period.size();
+	period.push_back(0);
+	seq.push_back(0);
+	pos.push_back(0);
+	meta.push_back(0);
+    }
+    else {
+	i = free.back();
+	free.pop_back();
+    }
+
+    period[i] = dt.count();
+    meta[i] = (meta[i] >> flags << flags) | live | (repeat ? repeating : 0);
+    seq[i] = serial++;
+    push({(t + dt).time_since_epoch().count(), i});
+    return id(i);
+}
+
+/**
+ * Cancel a timer, if the Id is still valid.
+ */
+void Slab::cancel(Id id)
+{
+    if (!valid(id)) return;
+    const std::uint32_t i = id;
+    take(pos[i]);
+    release(i);
+}
+
+/**
+ * True if the timer hasn't been cancelled, and hasn't elapsed (or
+ * repeats).
+ */
+bool Slab::active(Id id) const
+{
+    return valid(id);
+}
+
+/**
+ * Like Clock::set(t, elapsed): consume the timers due by t, append
+ * them to 'elapsed', reschedule repeating ones, and return the
+ * snooze time.
+ */
+Slab::ref::duration Slab::set(time_point t, std::vector<Id>& elapsed)
+{
+    const rep now = t.time_since_epoch().count();
+    while (!heap.empty() && heap.front().t <= now) {
+	const Entry e = heap.front();
+	elapsed.push_back(id(e.i));
+	take(0);
+	if ((meta[e.i] & repeating) && period[e.i] > 0) {
+	    seq[e.i] = serial++;
+	    push({e.t + period[e.i], e.i});
+	}
+	else {
+	    release(e.i);
+	}
+    }
+
+    if (f.stopped()) return ref::duration::max();
+    if (heap.empty()) return std::chrono::hours{1};
+    return f.inverse(duration {heap.front().t - now});
+}
+
+/**
+ * The time of the first timer to strike, or false if there are none.
+ */
+bool Slab::next(time_point& t) const
+{
+    if (heap.empty()) return false;
+    t = time_point {duration {heap.front().t}};
+    return true;
+}
+
+/**
+ * The reference time when the first timer strikes, or max() if
+ * never. See Clock::deadline().
+ */
+Slab::ref::time_point Slab::deadline() const
+{
+    time_point t;
+    if (f.stopped() || !next(t)) return ref::time_point::max();
+    return f.inverse(t);
+}
+
+Slab::Id Slab::id(std::uint32_t i) const
+{
+    return Id {meta[i] >> flags} << 32 | i;
+}
+
+bool Slab::valid(Id id) const
+{
+    const std::uint32_t i = id;
+    return i < meta.size() && (meta[i] & live) && (meta[i] >> flags) == id >> 32;
+}
+
+/* The timer at i is off the heap; the next one there gets another
+ * generation.
+ */
+void Slab::release(std::uint32_t i)
+{
+    meta[i] = ((meta[i] >> flags) + 1) << flags;
+    free.push_back(i);
+}
+
+bool Slab::less(const Entry& a, const Entry& b) const
+{
+    if (a.t != b.t) return a.t < b.t;
+    return seq[a.i] < seq[b.i];
+}
+
+void Slab::place(std::size_t k, const Entry& e)
+{
+    heap[k] = e;
+    pos[e.i] = k;
+}
+
+void Slab::push(const Entry& e)
+{
+    heap.push_back(e);
+    sift_up(heap.size() - 1);
+}
+
+void Slab::take(std::size_t k)
+{
+    const Entry last = heap.back();
+    heap.pop_back();
+    if (k == heap.size()) return;
+
+    place(k, last);
+    if (k && less(heap[k], heap[(k-1)/4])) sift_up(k);
+    else sift_down(k);
+}
+
+void Slab::sift_up(std::size_t k)
+{
+    const Entry e = heap[k];
+    while (k) {
+	const std::size_t parent = (k-1)/4;
+	if (!less(e, heap[parent])) break;
+	place(k, heap[parent]);
+	k = parent;
+    }
+    place(k, e);
+}
+
+void Slab::sift_down(std::size_t k)
+{
+    const Entry e = heap[k];
+    const std::size_t n = heap.size();
+    for (;;) {
+	const std::size_t first = 4*k + 1;
+	if (first >= n) break;
+	const std::size_t end = std::min(first + 4, n);
+	std::size_t best = first;
+	for (std::size_t c = first + 1; c < end; c++) {
+	    if (less(heap[c], heap[best])) best = c;
+	}
+	if (!less(heap[best], e)) break;
+	place(k, heap[best]);
+	k = best;
+    }
+    place(k, e);
+}
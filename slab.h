@@ -0,0 +1,93 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_SLAB_H_
+#define SHOWTIME_SLAB_H_
+
+#include "showtime.h"
+
+#include <cstdint>
+
+namespace showtime {
+
+    /**
+     * Timers for when there are millions of them: a clock like
+     * Clock, but instead of Timer objects of your own, with their
+     * vtables and fixed addresses, the timers are kept here, as
+     * arrays of deadlines, periods and so on. You get an Id for
+     * each, and that's what set() lists when they elapse.
+     *
+     * The schedule is a 4-ary heap of deadline and index, 16 bytes
+     * an entry. Comparing entries reads nothing else unless the
+     * deadlines tie: then the timers' sequence numbers decide, so
+     * that they keep their order. Moving an entry updates its
+     * timer's position, too. A timer costs about 40 bytes, all told.
+     *
+     * An Id is an index and a generation. A one-shot timer's Id is
+     * no longer valid once it's elapsed or cancelled, and cancelling
+     * an invalid Id does nothing, even if the index has been reused.
+     *
+     * There's no coalescing, slack or dispatch; see Clock for those.
+     */
+    class Slab {
+    public:
+	using time_point = Clock::time_point;
+	using duration = Clock::duration;
+	using ref = Clock::ref;
+	using Id = std::uint64_t;
+
+	Slab() = default;
+	Slab(const Slab&) = delete;
+	Slab& operator= (const Slab&) = delete;
+
+	void change(time_point a, time_point b, double v);
+	void change(const Linear<Clock>& g) { f = g; }
+	const Linear<Clock>& mapping() const { return f; }
+	time_point at(ref::time_point ref) const { return f(ref); }
+
+	Id add(time_point t, duration dt, bool repeat = false);
+	void cancel(Id id);
+	bool active(Id id) const;
+	std::size_t size() const { return heap.size(); }
+
+	ref::duration set(time_point t, std::vector<Id>& elapsed);
+	bool next(time_point& t) const;
+	ref::time_point deadline() const;
+
+    private:
+	using rep = duration::rep;
+
+	struct Entry {
+	    rep t;
+	    std::uint32_t i;
+	};
+
+	Linear<Clock> f;
+
+	/* per timer */
+	std::vector<rep> period;
+	std::vector<std::uint64_t> seq;
+	std::vector<std::uint32_t> pos;
+	std::vector<std::uint32_t> meta;
+
+	std::vector<Entry> heap;
+	std::vector<std::uint32_t> free;
+	std::uint64_t serial = 0;
+
+	static constexpr std::uint32_t live = 1;
+	static constexpr std::uint32_t repeating = 2;
+	static constexpr unsigned flags = 2;
+
+	Id id(std::uint32_t i) const;
+	bool valid(Id id) const;
+	void release(std::uint32_t i);
+
+	bool less(const Entry& a, const Entry& b) const;
+	void place(std::size_t k, const Entry& e);
+	void push(const Entry& e);
+	void take(std::size_t k);
+	void sift_up(std::size_t k);
+	void sift_down(std::size_t k);
+    };
+}
+#endif
@@ -0,0 +1,85 @@
+#include "snapshot.h"
+
+#include <cstring>
+
+using showtime::Snapshot;
+using showtime::Linear;
+using showtime::Clock;
+
+namespace {
+
+    const char magic[8] = {'s', 'h', 'o', 'w', 't', 'i', 'm', 'e'};
+    const std::uint32_t version = 1;
+}
+
+/**
+ * The clock's mapping and timers, with each timer saved as id(tm).
+ */
+std::vector<char> Snapshot::save(const Clock& clock, const Id& id)
+{
+    std::vector<Clock::Entry> v;
+    clock.list(v);
+
+    std::size_t n = 0;
+    for (const auto& e : v) n += !e.tm->cancelled;
+
+    Header h;
+    std::memcpy(h.magic, magic, sizeof magic);
+    h.version = version;
+    h.record = sizeof(Record);
+    const Linear<Clock>& f = clock.mapping();
+    h.num = f.numerator();
+    h.den = f.denominator();
+    h.m = f.offset().count();
+    h.n = n;
+
+    std::vector<char> buf(sizeof h + n * sizeof(Record));
+    std::memcpy(buf.data(), &h, sizeof h);
+    char* p = buf.data() + sizeof h;
+    for (const auto& e : v) {
+	if (e.tm->cancelled) continue;
+	const Record r {e.t.time_since_epoch().count(), id(e.tm)};
+	std::memcpy(p, &r, sizeof r);
+	p += sizeof r;
+    }
+    return buf;
+}
+
+/**
+ * Load a snapshot of 'size' bytes at p into the clock: set its
+ * mapping, and schedule the timers, each as timer(id). Timers for
+ * which that's nullptr are left out. Timers already on the clock
+ * stay, but loading into an empty one is the fast case.
+ *
+ * Returns false, without changing the clock, if p isn't a snapshot
+ * (or not one of this version).
+ */
+bool Snapshot::load(Clock& clock, const void* p, std::size_t size,
+		    const Lookup& timer)
+{
+    Header h;
+    if (size < sizeof h) return false;
+    std::memcpy(&h, p, sizeof h);
+    if (std::memcmp(h.magic, magic, sizeof magic)) return false;
+    if (h.version != version || h.record != sizeof(Record)) return false;
+    if (h.den <= 0) return false;
+    if (h.n > (size - sizeof h) / sizeof(Record)) return false;
+
+    const char* q = static_cast<const char*>(p) + sizeof h;
+    std::vector<Clock::Entry> v;
+    v.reserve(h.n);
+    for (std::uint64_t i = 0; i < h.n; i++) {
+	Record r;
+	std::memcpy(&r, q, sizeof r);
+	q += sizeof r;
+	Timer* const tm = timer(r.id);
+	if (!tm) continue;
+	const Clock::time_point t {Clock::duration {r.t}};
+	if (!v.empty() && t < v.back().t) return false;
+	v.push_back({t, tm});
+    }
+
+    clock.change({Linear<Clock> {}, Clock::duration {h.m}, h.num, h.den});
+    clock.insert(v.data(), v.data() + v.size());
+    return true;
+}
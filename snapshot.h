@@ -0,0 +1,55 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_SNAPSHOT_H_
+#define SHOWTIME_SNAPSHOT_H_
+
+#include "showtime.h"
+
+#include <cstdint>
+#include <functional>
+
+namespace showtime {
+
+    /**
+     * A Clock's state, in a compact binary form: the mapping from
+     * the reference clock, and the scheduled timers. Since a Timer's
+     * identity is its address, the timers are saved by IDs of the
+     * caller's choosing, and looked up again when loading.
+     *
+     * The format is a Header followed by n Records, sorted by time
+     * (and for timers at the same time, by the order they would
+     * elapse). It's in native byte order, with everything aligned,
+     * so that load() can read it straight from a mapped file.
+     *
+     * Since the records are sorted, loading builds the schedule in
+     * linear time (for the Map, Wheel, Heap and Lists, anyway)
+     * rather than N log N. Cancelled timers aren't saved, and
+     * neither are the settings: coalesce() and slack().
+     */
+    class Snapshot {
+    public:
+	struct Header {
+	    char magic[8];
+	    std::uint32_t version;
+	    std::uint32_t record;
+	    std::int64_t num;
+	    std::int64_t den;
+	    std::int64_t m;
+	    std::uint64_t n;
+	};
+
+	struct Record {
+	    std::int64_t t;
+	    std::uint64_t id;
+	};
+
+	using Id = std::function<std::uint64_t (const Timer*)>;
+	using Lookup = std::function<Timer* (std::uint64_t)>;
+
+	static std::vector<char> save(const Clock& clock, const Id& id);
+	static bool load(Clock& clock, const void* p, std::size_t size,
+			 const Lookup& timer);
+    };
+}
+#endif
@@ -0,0 +1,367 @@
+/*
+ * Micro-benchmarks for the Clock, with its different Schedules.
+ *
+ * test/bench [-n size] ... [name ...]
+ *
+ * runs the benchmarks whose names contain any of the arguments (or
+ * all of them) and prints one line for each benchmark, schedule
+ * and size, tab-separated:
+ *
+ * benchmark  schedule  n  ns/op
+ *
+ * The sizes are the ones given with -n, or the default ones below,
+ * where the other parameters are too.
+ */
+#include <showtime.h>
+#include <map.h>
+#include <wheel.h>
+#include <lists.h>
+#include <heap.h>
+#include <slab.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Schedule;
+    using showtime::Timer;
+
+    using std::chrono::milliseconds;
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    struct Backend {
+	const char* name;
+	std::function<Schedule* ()> make;
+    };
+
+    const Backend backends[] = {
+	{"map", [] () -> Schedule* { return new showtime::Map; }},
+	{"wheel", [] () -> Schedule* { return new showtime::Wheel; }},
+	{"lists", [] () -> Schedule* { return new showtime::Lists; }},
+	{"heap", [] () -> Schedule* { return new showtime::Heap; }},
+    };
+
+    std::vector<unsigned> sizes = {1000, 100000};
+
+    /* How much the benchmarks which loop do. */
+    const struct {
+	unsigned set0 = 100000;		/* set() calls */
+	unsigned idle = 4;		/* times n timers expiring */
+	unsigned jump = 1000;		/* n per repeating timer */
+	unsigned at = 10;		/* passes over n time points */
+    } rounds;
+
+    /* Something which the optimizer can't see through. */
+    volatile long sink;
+
+    using steady = std::chrono::steady_clock;
+
+    void report(const char* name, const char* backend, unsigned n,
+		steady::duration dt, unsigned long ops)
+    {
+	const double ns = std::chrono::duration<double, std::nano>(dt).count();
+	std::printf("%s\t%s\t%u\t%.1f\n", name, backend, n, ops ? ns / ops : 0.0);
+	std::fflush(stdout);
+    }
+
+    /* n timers with durations 1 ms .. 1 h, in a fixed random order:
+     * almost all different. Or with only k different durations.
+     */
+    std::vector<std::unique_ptr<Timer>> timers(unsigned n, unsigned k = 3600000)
+    {
+	std::mt19937 rng {4711};
+	std::vector<std::unique_ptr<Timer>> v;
+	v.reserve(n);
+	for (unsigned i = 0; i < n; i++) {
+	    const unsigned dt = 1 + (rng() % k) * (3600000 / k);
+	    v.emplace_back(new Timer {milliseconds{dt}});
+	}
+	return v;
+    }
+
+    std::unique_ptr<Schedule> schedule(const Backend& b)
+    {
+	return std::unique_ptr<Schedule> {b.make()};
+    }
+
+    /* Adding n timers to an empty clock. */
+    void add(const Backend& b, unsigned n)
+    {
+	auto v = timers(n);
+	Clock clock {schedule(b)};
+	const auto t = steady::now();
+	for (auto& tm : v) clock.add(t0, tm.get());
+	report("add", b.name, n, steady::now() - t, n);
+    }
+
+    /* Removing n timers, in another order than they were added. */
+    void remove(const Backend& b, unsigned n)
+    {
+	auto v = timers(n);
+	Clock clock {schedule(b)};
+	for (auto& tm : v) clock.add(t0, tm.get());
+	const auto t = steady::now();
+	for (unsigned i = 0; i < n; i++) clock.remove(v[(i * 7919) % n].get());
+	report("remove", b.name, n, steady::now() - t, n);
+    }
+
+    /* The same two, with only 16 different durations. */
+    void add16(const Backend& b, unsigned n)
+    {
+	auto v = timers(n, 16);
+	Clock clock {schedule(b)};
+	const auto t = steady::now();
+	for (auto& tm : v) clock.add(t0, tm.get());
+	report("add16", b.name, n, steady::now() - t, n);
+    }
+
+    void remove16(const Backend& b, unsigned n)
+    {
+	auto v = timers(n, 16);
+	Clock clock {schedule(b)};
+	for (auto& tm : v) clock.add(t0, tm.get());
+	const auto t = steady::now();
+	for (unsigned i = 0; i < n; i++) clock.remove(v[(i * 7919) % n].get());
+	report("remove16", b.name, n, steady::now() - t, n);
+    }
+
+    /* set() with n timers, and none of them due. */
+    void set0(const Backend& b, unsigned n)
+    {
+	auto v = timers(n);
+	Clock clock {schedule(b)};
+	for (auto& tm : v) clock.add(t0 + milliseconds{1}, tm.get());
+	std::vector<Timer*> acc;
+	const unsigned k = rounds.set0;
+	const auto t = steady::now();
+	for (unsigned i = 0; i < k; i++) sink = clock.set(t0, acc).count();
+	report("set0", b.name, n, steady::now() - t, k);
+    }
+
+    /* set() with n timers, stepping so that about one is due each
+     * time.
+     */
+    void set1(const Backend& b, unsigned n)
+    {
+	std::vector<std::unique_ptr<Timer>> v;
+	for (unsigned i = 0; i < n; i++) v.emplace_back(new Timer {milliseconds{i + 1}});
+	Clock clock {schedule(b)};
+	for (auto& tm : v) clock.add(t0, tm.get());
+	std::vector<Timer*> acc;
+	acc.reserve(n);
+	const auto t = steady::now();
+	for (unsigned i = 0; i < n; i++) clock.set(t0 + milliseconds{i + 1}, acc);
+	report("set1", b.name, n, steady::now() - t, n);
+    }
+
+    /* One set() where all n timers are due. */
+    void setN(const Backend& b, unsigned n)
+    {
+	auto v = timers(n);
+	Clock clock {schedule(b)};
+	for (auto& tm : v) clock.add(t0, tm.get());
+	std::vector<Timer*> acc;
+	acc.reserve(n);
+	const auto t = steady::now();
+	clock.set(t0 + hours{2}, acc);
+	report("setN", b.name, n, steady::now() - t, n);
+    }
+
+    /* A day's jump with n/rounds.jump repeating ten-minute timers:
+     * each is listed 144 times. Per listed timer.
+     */
+    void jump(const Backend& b, unsigned n)
+    {
+	const unsigned k = n / rounds.jump;
+	std::vector<std::unique_ptr<Timer>> v;
+	for (unsigned i = 0; i < k; i++) v.emplace_back(new Timer {minutes{10}, true});
+	Clock clock {schedule(b)};
+	for (auto& tm : v) clock.add(t0, tm.get());
+	std::vector<Timer*> acc;
+	const auto t = steady::now();
+	clock.set(t0 + hours{24}, acc);
+	report("jump", b.name, n, steady::now() - t, acc.size());
+    }
+
+    /* The same, coalescing. Per timer. */
+    void jump_coalesce(const Backend& b, unsigned n)
+    {
+	const unsigned k = n / rounds.jump;
+	std::vector<std::unique_ptr<Timer>> v;
+	for (unsigned i = 0; i < k; i++) v.emplace_back(new Timer {minutes{10}, true});
+	Clock clock {schedule(b)};
+	clock.coalesce(true);
+	for (auto& tm : v) clock.add(t0, tm.get());
+	std::vector<Timer*> acc;
+	const auto t = steady::now();
+	clock.set(t0 + hours{24}, acc);
+	report("jump_coalesce", b.name, n, steady::now() - t, acc.size());
+    }
+
+    /* n timers with the same deadline, then expiring them. */
+    void storm(const Backend& b, unsigned n)
+    {
+	std::vector<std::unique_ptr<Timer>> v;
+	for (unsigned i = 0; i < n; i++) v.emplace_back(new Timer {seconds{30}});
+	Clock clock {schedule(b)};
+	std::vector<Timer*> acc;
+	acc.reserve(n);
+	const auto t = steady::now();
+	for (auto& tm : v) clock.add(t0, tm.get());
+	clock.set(t0 + seconds{30}, acc);
+	report("storm", b.name, n, steady::now() - t, n);
+    }
+
+    /* Idle timeouts: a stream of same-dt timers, added and expiring
+     * at the same pace, n of them outstanding.
+     */
+    void idle(const Backend& b, unsigned n)
+    {
+	std::vector<std::unique_ptr<Timer>> v;
+	for (unsigned i = 0; i < n; i++) v.emplace_back(new Timer {seconds{30}});
+	Clock clock {schedule(b)};
+	std::vector<Timer*> acc;
+	const Clock::duration step = seconds{30} / n;
+	for (unsigned i = 0; i < n; i++) clock.add(t0 + i*step, v[i].get());
+	const unsigned k = rounds.idle * n;
+	const auto t = steady::now();
+	for (unsigned i = n; i < n + k; i++) {
+	    const auto now = t0 + i*step;
+	    acc.clear();
+	    clock.set(now, acc);
+	    for (Timer* tm : acc) clock.add(now, tm);
+	}
+	report("idle", b.name, n, steady::now() - t, k);
+    }
+
+    /* Clock::at(), one by one and in batches, at a few speeds. */
+    void at(unsigned n)
+    {
+	std::vector<Clock::time_point> a(n);
+	for (unsigned i = 0; i < n; i++) a[i] = t0 + milliseconds{i};
+	std::vector<Clock::time_point> out(n);
+
+	const struct {
+	    const char* name;
+	    double v;
+	} speeds[] = {{"1", 1}, {"2", 2}, {"1/3", 1.0/3}};
+
+	for (const auto& speed : speeds) {
+	    Clock clock;
+	    clock.change(t0, t0 + hours{1}, speed.v);
+	    const unsigned k = rounds.at;
+
+	    auto t = steady::now();
+	    for (unsigned j = 0; j < k; j++) {
+		for (unsigned i = 0; i < n; i++) out[i] = clock.at(a[i]);
+	    }
+	    sink = out[n/2].time_since_epoch().count();
+	    report((std::string("at/") + speed.name).c_str(), "-", n, steady::now() - t, k*n);
+
+	    t = steady::now();
+	    for (unsigned j = 0; j < k; j++) clock.at(a.data(), a.data() + n, out.data());
+	    sink = out[n/2].time_since_epoch().count();
+	    report((std::string("at[]/") + speed.name).c_str(), "-", n, steady::now() - t, k*n);
+	}
+    }
+
+    /* Adding, removing and expiring on a Slab, which isn't a
+     * Schedule but does the same job.
+     */
+    void slab(unsigned n)
+    {
+	std::mt19937 rng {4711};
+	std::vector<Clock::duration> dt;
+	for (unsigned i = 0; i < n; i++) dt.push_back(milliseconds{1 + rng() % 3600000});
+
+	showtime::Slab s;
+	std::vector<showtime::Slab::Id> id;
+	id.reserve(n);
+	auto t = steady::now();
+	for (unsigned i = 0; i < n; i++) id.push_back(s.add(t0, dt[i]));
+	report("add", "slab", n, steady::now() - t, n);
+
+	t = steady::now();
+	for (unsigned i = 0; i < n; i++) s.cancel(id[(i * 7919) % n]);
+	report("remove", "slab", n, steady::now() - t, n);
+
+	for (unsigned i = 0; i < n; i++) s.add(t0, dt[i]);
+	std::vector<showtime::Slab::Id> acc;
+	acc.reserve(n);
+	t = steady::now();
+	s.set(t0 + hours{2}, acc);
+	report("setN", "slab", n, steady::now() - t, n);
+    }
+
+    bool wanted(const std::vector<const char*>& names, const char* name)
+    {
+	if (names.empty()) return true;
+	for (const char* s : names) {
+	    if (std::strstr(name, s)) return true;
+	}
+	return false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const struct {
+	const char* name;
+	void (*f)(const Backend&, unsigned);
+    } benchmarks[] = {
+	{"add", add},
+	{"remove", remove},
+	{"add16", add16},
+	{"remove16", remove16},
+	{"set0", set0},
+	{"set1", set1},
+	{"setN", setN},
+	{"jump", jump},
+	{"jump_coalesce", jump_coalesce},
+	{"storm", storm},
+	{"idle", idle},
+    };
+
+    std::vector<unsigned> ns;
+    std::vector<const char*> names;
+    for (int i = 1; i < argc; i++) {
+	if (std::strcmp(argv[i], "-n")) {
+	    names.push_back(argv[i]);
+	    continue;
+	}
+	const unsigned long n = i+1 < argc ? std::strtoul(argv[++i], nullptr, 10) : 0;
+	if (!n) {
+	    std::fprintf(stderr, "usage: %s [-n size] ... [name ...]\n", argv[0]);
+	    return 1;
+	}
+	ns.push_back(n);
+    }
+    if (!ns.empty()) sizes = ns;
+
+    std::printf("# benchmark\tschedule\tn\tns/op\n");
+    for (const auto& bm : benchmarks) {
+	if (!wanted(names, bm.name)) continue;
+	for (const Backend& b : backends) {
+	    for (unsigned n : sizes) bm.f(b, n);
+	}
+    }
+    if (wanted(names, "slab")) {
+	for (unsigned n : sizes) slab(n);
+    }
+    if (wanted(names, "at")) {
+	for (unsigned n : sizes) at(n);
+    }
+    return 0;
+}
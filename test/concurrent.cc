@@ -0,0 +1,100 @@
+#include <concurrent.h>
+
+#include <orchis.h>
+
+#include <map>
+#include <thread>
+
+namespace concurrent {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    using showtime::Clock;
+    using showtime::Concurrent;
+    using showtime::Timer;
+
+    using std::chrono::minutes;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    void wakeup(TC)
+    {
+	Clock clock;
+	Concurrent cc {clock};
+	Timer a {minutes{1}};
+	Timer b {minutes{2}};
+
+	assert_true(cc.add(t0, &a));
+	assert_true(!cc.add(t0, &b));
+	assert_true(!cc.remove(&a));
+
+	auto res = cc.set(t0 + minutes{5});
+	assert_eq(res.elapsed.size(), 1);
+	assert_true(res.elapsed[0] == &b);
+
+	assert_true(cc.add(t0, &a));
+    }
+
+    void replace(TC)
+    {
+	Clock clock;
+	Concurrent cc {clock};
+	Timer a {minutes{1}};
+	Timer b {minutes{2}};
+
+	assert_true(cc.add(t0, &a));
+	assert_true(!cc.add(t0, &b));
+	assert_true(!cc.add(t0 + minutes{10}, &a));
+	assert_true(!cc.remove(&b));
+	assert_true(!cc.add(t0 + minutes{1}, &b));
+
+	auto res = cc.set(t0 + minutes{5});
+	assert_eq(res.elapsed.size(), 1);
+	assert_true(res.elapsed[0] == &b);
+	res = cc.set(t0 + minutes{11});
+	assert_eq(res.elapsed.size(), 1);
+	assert_true(res.elapsed[0] == &a);
+
+	assert_true(cc.remove(&a));
+	assert_true(!cc.remove(&a));
+	cc.drain();
+	assert_true(cc.add(t0, &a));
+    }
+
+    void threads(TC)
+    {
+	Clock clock;
+	Concurrent cc {clock};
+
+	const unsigned n = 4;
+	const unsigned m = 10000;
+	std::vector<std::unique_ptr<Timer>> timers;
+	for (unsigned i = 0; i < n*m; i++) {
+	    timers.emplace_back(new Timer {minutes{1 + i%60}});
+	}
+
+	std::vector<std::thread> producers;
+	for (unsigned i = 0; i < n; i++) {
+	    producers.emplace_back([&cc, &timers, i, m] {
+		for (unsigned j = i*m; j < (i+1)*m; j++) {
+		    cc.add(t0, timers[j].get());
+		    if (j%2) cc.remove(timers[j].get());
+		}
+	    });
+	}
+
+	std::vector<Timer*> elapsed;
+	for (int i = 0; i < 1000; i++) cc.set(t0, elapsed);
+	for (auto& th : producers) th.join();
+	cc.set(t0 + minutes{60}, elapsed);
+
+	std::map<Timer*, unsigned> index;
+	for (unsigned i = 0; i < n*m; i++) index[timers[i].get()] = i;
+
+	assert_eq(elapsed.size(), n*m/2);
+	for (Timer* tm : elapsed) assert_eq(index[tm] % 2, 0);
+    }
+}
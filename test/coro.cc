@@ -0,0 +1,91 @@
+#include <coro.h>
+
+#include <orchis.h>
+
+#include <string>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Sleep;
+
+    using std::chrono::minutes;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    /* The least a coroutine needs, to be started and destroyed.
+     */
+    struct Task {
+	struct promise_type {
+	    Task get_return_object() {
+		return Task {std::coroutine_handle<promise_type>::from_promise(*this)};
+	    }
+	    std::suspend_never initial_suspend() noexcept { return {}; }
+	    std::suspend_always final_suspend() noexcept { return {}; }
+	    void return_void() {}
+	    void unhandled_exception() { throw; }
+	};
+
+	explicit Task(std::coroutine_handle<promise_type> h) : h {h} {}
+	Task(const Task&) = delete;
+	~Task() { h.destroy(); }
+	bool done() const { return h.done(); }
+
+	std::coroutine_handle<promise_type> h;
+    };
+
+    /* Every dt, n times, write a name down.
+     */
+    Task sleeper(Clock& clock, const Clock::time_point& now,
+		 std::string& log, char name, minutes dt, int n)
+    {
+	for (int i = 0; i < n; i++) {
+	    co_await Sleep {clock, now, dt};
+	    log.push_back(name);
+	}
+    }
+}
+
+namespace coro {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void sleep(TC)
+    {
+	Clock clock;
+	Clock::time_point now = t0;
+	std::string log;
+
+	Task a = sleeper(clock, now, log, 'a', minutes{10}, 3);
+	Task b = sleeper(clock, now, log, 'b', minutes{15}, 2);
+
+	for (int m = 0; m < 60; m += 5) {
+	    now = t0 + minutes{m};
+	    clock.dispatch(now);
+	}
+	assert_eq(log, "ababa");
+	assert_true(a.done());
+	assert_true(b.done());
+	Clock::time_point t;
+	assert_true(!clock.next(t));
+    }
+
+    void cancel(TC)
+    {
+	Clock clock;
+	Clock::time_point now = t0;
+	std::string log;
+	{
+	    Task a = sleeper(clock, now, log, 'a', minutes{10}, 3);
+	    Clock::time_point t;
+	    assert_true(clock.next(t));
+	}
+	Clock::time_point t;
+	assert_true(!clock.next(t));
+	clock.dispatch(t0 + minutes{60});
+	assert_eq(log, "");
+    }
+}
@@ -0,0 +1,106 @@
+#include <group.h>
+
+#include <orchis.h>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Group;
+    using showtime::Linear;
+    using showtime::Timer;
+
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    /* Speed k, showing 'shows' at reference time 'ref'. */
+    Linear<Clock> mapping(Clock::time_point ref, Clock::time_point shows, long k)
+    {
+	return {Linear<Clock>{}, shows.time_since_epoch() - k*ref.time_since_epoch(), k, 1};
+    }
+}
+
+namespace group {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void empty(TC)
+    {
+	Group g;
+	std::vector<Timer*> v;
+	assert_true(g.set(t0, v) == Clock::ref::time_point::max());
+	assert_true(g.deadline() == Clock::ref::time_point::max());
+    }
+
+    void merge(TC)
+    {
+	Clock a;
+	Clock b;
+	Clock c;
+	b.change(mapping(t0, t0, 2));
+	c.change(mapping(t0, t0, 0));
+
+	Group g;
+	for (Clock* p : {&a, &b, &c}) g.join(*p);
+	assert_eq(g.size(), 3);
+
+	Timer ta {minutes{30}};
+	Timer tb {minutes{30}};
+	Timer tc {minutes{1}};
+	g.add(a, t0, &ta);
+	g.add(b, t0, &tb);
+	g.add(c, t0, &tc);
+	assert_true(g.deadline() == t0 + minutes{15});
+
+	std::vector<Timer*> v;
+	assert_true(g.set(t0 + minutes{10}, v) == t0 + minutes{15});
+	assert_eq(v.size(), 0);
+	assert_true(g.set(t0 + minutes{20}, v) == t0 + minutes{30});
+	assert_eq(v.size(), 1);
+	assert_true(v[0] == &tb);
+	assert_true(g.set(t0 + minutes{30}, v) == Clock::ref::time_point::max());
+	assert_eq(v.size(), 2);
+	assert_true(v[1] == &ta);
+
+	/* c starts, at twice the speed */
+	c.change(mapping(t0 + minutes{30}, t0, 2));
+	g.update(c);
+	assert_true(c.at(t0 + minutes{30}) == t0);
+	assert_true(g.deadline() == t0 + minutes{30} + seconds{30});
+	g.leave(c);
+	assert_true(g.deadline() == Clock::ref::time_point::max());
+	g.leave(c);
+	assert_eq(g.size(), 2);
+    }
+
+    void dispatch(TC)
+    {
+	struct Leaving : Timer {
+	    Leaving(Group& g, Clock& c) : Timer {seconds{1}, true}, g(g), c(c) {}
+	    void fire() override { n++; if (n==3) g.leave(c); }
+	    Group& g;
+	    Clock& c;
+	    int n = 0;
+	};
+
+	Clock a;
+	Clock b;
+	Group g;
+	g.join(a);
+	g.join(b);
+	Leaving la {g, a};
+	Leaving lb {g, b};
+	g.add(a, t0, &la);
+	g.add(b, t0, &lb);
+
+	for (int i = 1; i < 10; i++) g.dispatch(t0 + seconds{i});
+	assert_eq(la.n, 3);
+	assert_eq(lb.n, 3);
+	assert_eq(g.size(), 0);
+    }
+}
@@ -0,0 +1,223 @@
+#include <heap.h>
+#include <map.h>
+
+#include <orchis.h>
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Schedule;
+    using showtime::Timer;
+    using showtime::Heap;
+    using showtime::Map;
+
+    using std::chrono::milliseconds;
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    /* Pop everything up to t, and name the timers in the order they
+     * came, by their index in 'tm'.
+     */
+    std::string drain(Schedule& s, Clock::time_point t,
+		      const std::vector<Timer*>& tm)
+    {
+	std::string acc;
+	Schedule::Entry e;
+	while (s.pop(t, e)) {
+	    const auto it = std::find(begin(tm), end(tm), e.tm);
+	    acc.push_back('a' + (it - begin(tm)));
+	}
+	return acc;
+    }
+}
+
+namespace heap {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void empty(TC)
+    {
+	Heap h;
+	assert_true(!h.front());
+	Schedule::Entry e;
+	assert_true(!h.pop(t0 + hours{24}, e));
+	assert_eq(h.size(), 0);
+    }
+
+    void order(TC)
+    {
+	Heap h;
+	Timer a {milliseconds{3}};
+	Timer b {seconds{2}};
+	Timer c {minutes{3}};
+	Timer d {hours{4}};
+	Timer e {hours{24*30}};
+	Timer f {milliseconds{0}};
+	const std::vector<Timer*> tm {&a, &b, &c, &d, &e, &f};
+
+	for (Timer* p : {&e, &c, &a, &d, &f, &b}) h.insert(t0 + p->dt, p);
+
+	assert_true(h.front()->tm == &f);
+	assert_eq(drain(h, t0 + hours{24*365}, tm), "fabcde");
+	assert_true(!h.front());
+    }
+
+    void same_time(TC)
+    {
+	Heap h;
+	std::vector<std::unique_ptr<Timer>> v;
+	std::vector<Timer*> tm;
+	for (int i = 0; i < 26; i++) {
+	    v.emplace_back(new Timer {minutes{5}});
+	    tm.push_back(v.back().get());
+	}
+	for (int i = 25; i >= 0; i -= 2) h.insert(t0 + minutes{i%3}, tm[i]);
+	for (int i = 0; i < 26; i += 2) h.insert(t0 + minutes{i%3}, tm[i]);
+
+	assert_eq(drain(h, t0 + minutes{5}, tm), "vpjdagmsy" "ztnhbekqw" "xrlfciou");
+    }
+
+    void remove(TC)
+    {
+	Heap h;
+	Timer a {milliseconds{1}};
+	Timer b {hours{1}};
+	Timer c {hours{24*100}};
+	const std::vector<Timer*> tm {&a, &b, &c};
+
+	for (Timer* p : tm) h.insert(t0 + p->dt, p);
+	h.insert(t0 + hours{2}, &a);
+	h.remove(&a);
+	h.remove(&a);
+	assert_true(h.front()->tm == &b);
+	h.remove(&b);
+	assert_true(h.front()->tm == &c);
+	assert_eq(h.size(), 1);
+
+	assert_eq(drain(h, t0 + hours{24*365}, tm), "c");
+    }
+
+    void destroy(TC)
+    {
+	Timer a {milliseconds{1}};
+	const std::vector<Timer*> tm {&a};
+	{
+	    Heap h;
+	    h.insert(t0, &a);
+	}
+	Heap h;
+	{
+	    Timer b {milliseconds{1}};
+	    h.insert(t0, &b);
+	    h.insert(t0, &a);
+	}
+	assert_eq(drain(h, t0, tm), "a");
+    }
+
+    void compact(TC)
+    {
+	Heap h;
+	std::vector<Timer*> tm;
+	std::vector<std::unique_ptr<Timer>> v;
+	for (int i = 0; i < 26; i++) {
+	    v.emplace_back(new Timer {seconds{1}});
+	    tm.push_back(v.back().get());
+	}
+	for (int i = 25; i >= 0; i--) h.insert(t0 + seconds{i}, tm[i]);
+	for (int i = 0; i < 26; i++) {
+	    if (i%3) v[i]->cancelled = true;
+	}
+	assert_eq(h.cancelled(), 17);
+
+	assert_eq(h.purge(), 17);
+	assert_eq(h.cancelled(), 0);
+	assert_eq(h.size(), 9);
+	v[1]->cancelled = false;
+	assert_eq(h.cancelled(), 0);
+	assert_eq(drain(h, t0 + hours{1}, tm), "adgjmpsvy");
+    }
+
+    void batch(TC)
+    {
+	Heap h;
+	Timer a {minutes{1}};
+	Timer b {minutes{2}};
+	Timer c {minutes{2}};
+	const std::vector<Timer*> tm {&a, &b, &c};
+
+	Schedule::Entry v[] = {{t0, &b}, {t0, &a}, {t0 + minutes{1}, &c}, {t0 + minutes{2}, &a}};
+	h.insert(v, v + 4);
+	assert_eq(h.size(), 3);
+	assert_eq(drain(h, t0 + minutes{5}, tm), "bca");
+    }
+
+    /* A random mix of inserts, removals and pops, against a Map.
+     */
+    void random(TC)
+    {
+	std::mt19937 rng {4711};
+	std::vector<std::unique_ptr<Timer>> v;
+	std::vector<std::unique_ptr<Timer>> w;
+	std::vector<Timer*> tm;
+	std::vector<Timer*> tw;
+	for (int i = 0; i < 26; i++) {
+	    v.emplace_back(new Timer {seconds{1}});
+	    w.emplace_back(new Timer {seconds{1}});
+	    tm.push_back(v.back().get());
+	    tw.push_back(w.back().get());
+	}
+
+	Heap h;
+	Map m;
+	auto now = t0;
+	for (int n = 0; n < 20000; n++) {
+	    const unsigned i = rng() % 26;
+	    switch (rng() % 4) {
+	    case 0:
+	    case 1: {
+		const auto t = now + seconds{rng() % 20};
+		h.insert(t, tm[i]);
+		m.insert(t, tw[i]);
+		break;
+	    }
+	    case 2:
+		h.remove(tm[i]);
+		m.remove(tw[i]);
+		break;
+	    default:
+		now += seconds{rng() % 5};
+		assert_eq(drain(h, now, tm), drain(m, now, tw));
+		assert_eq(h.size(), m.size());
+		break;
+	    }
+	}
+	assert_eq(drain(h, now + minutes{10}, tm), drain(m, now + minutes{10}, tw));
+    }
+
+    void clock(TC)
+    {
+	Clock clock {std::unique_ptr<Schedule>{new Heap}};
+	Timer a {minutes{30}};
+	Timer b {minutes{15}};
+	Timer c {minutes{10}, true};
+
+	clock.add(t0, &a);
+	clock.add(t0, &b);
+	clock.add(t0, &c);
+
+	auto res = clock.set(t0 + minutes{30});
+	assert_eq(res.elapsed.size(), 5);
+	assert_true(res.elapsed[1] == &b);
+	assert_true(res.elapsed[3] == &a);
+	assert_true(res.snooze == minutes{10});
+    }
+}
@@ -0,0 +1,265 @@
+#include <lists.h>
+#include <map.h>
+
+#include <orchis.h>
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Schedule;
+    using showtime::Timer;
+    using showtime::Lists;
+    using showtime::Map;
+
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    /* Pop everything up to t, and name the timers in the order they
+     * came, by their index in 'tm'.
+     */
+    std::string drain(Schedule& s, Clock::time_point t,
+		      const std::vector<Timer*>& tm)
+    {
+	std::string acc;
+	Schedule::Entry e;
+	while (s.pop(t, e)) {
+	    const auto it = std::find(begin(tm), end(tm), e.tm);
+	    acc.push_back('a' + (it - begin(tm)));
+	}
+	return acc;
+    }
+}
+
+namespace lists {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void empty(TC)
+    {
+	Lists s;
+	assert_true(!s.front());
+	Schedule::Entry e;
+	assert_true(!s.pop(t0 + minutes{60}, e));
+    }
+
+    void idle(TC)
+    {
+	Lists s;
+	std::vector<std::unique_ptr<Timer>> v;
+	std::vector<Timer*> tm;
+	for (int i = 0; i < 6; i++) {
+	    v.emplace_back(new Timer {seconds{i%2 ? 30 : 40}});
+	    tm.push_back(v.back().get());
+	}
+	for (int i = 0; i < 6; i++) s.insert(t0 + seconds{i} + tm[i]->dt, tm[i]);
+
+	assert_true(s.front()->tm == tm[1]);
+	assert_eq(drain(s, t0 + seconds{39}, tm), "bdf");
+	assert_eq(drain(s, t0 + seconds{42}, tm), "ac");
+	s.remove(tm[4]);
+	assert_eq(drain(s, t0 + seconds{60}, tm), "");
+    }
+
+    void out_of_order(TC)
+    {
+	Lists s;
+	Timer a {minutes{5}};
+	Timer b {minutes{5}};
+	Timer c {minutes{5}};
+	Timer d {minutes{5}};
+	const std::vector<Timer*> tm {&a, &b, &c, &d};
+
+	s.insert(t0 + minutes{5}, &a);
+	s.insert(t0 + minutes{3}, &b);
+	s.insert(t0 + minutes{5}, &c);
+	s.insert(t0 + minutes{4}, &d);
+	assert_eq(drain(s, t0 + minutes{5}, tm), "bdac");
+    }
+
+    void same_time(TC)
+    {
+	Lists s;
+	Timer a {minutes{1}};
+	Timer b {minutes{2}};
+	Timer c {minutes{1}};
+	Timer d {minutes{3}};
+	const std::vector<Timer*> tm {&a, &b, &c, &d};
+
+	s.insert(t0, &a);
+	s.insert(t0, &b);
+	s.insert(t0, &c);
+	s.insert(t0, &d);
+	assert_eq(drain(s, t0, tm), "abcd");
+    }
+
+    void remove(TC)
+    {
+	Lists s;
+	Timer a {minutes{1}};
+	Timer b {minutes{1}};
+	Timer c {minutes{1}};
+	Timer d {minutes{1}};
+	const std::vector<Timer*> tm {&a, &b, &c, &d};
+
+	for (int i = 0; i < 4; i++) s.insert(t0 + minutes{i}, tm[i]);
+	s.remove(&b);
+	s.remove(&b);
+	s.remove(&a);
+	assert_true(s.front()->tm == &c);
+	s.insert(t0 + minutes{5}, &b);
+	s.remove(&d);
+	assert_eq(drain(s, t0 + minutes{10}, tm), "cb");
+	assert_true(!s.front());
+    }
+
+    /* Enough holes for the list to be compacted, and enough taken
+     * off the front for it to be trimmed.
+     */
+    void holes(TC)
+    {
+	std::vector<std::unique_ptr<Timer>> v;
+	std::vector<Timer*> tm;
+	for (int i = 0; i < 26; i++) {
+	    v.emplace_back(new Timer {minutes{1}});
+	    tm.push_back(v.back().get());
+	}
+
+	Lists s;
+	for (int i = 0; i < 26; i++) s.insert(t0 + seconds{i}, tm[i]);
+	for (int i = 1; i < 25; i++) {
+	    if (i%3) s.remove(tm[i]);
+	}
+	assert_eq(s.size(), 10);
+	s.remove(tm[24]);
+	assert_eq(drain(s, t0 + seconds{10}, tm), "adgj");
+
+	for (int i = 1; i < 25; i++) {
+	    if (i%3) s.insert(t0 + seconds{30 + i}, tm[i]);
+	}
+	s.remove(tm[15]);
+	assert_eq(drain(s, t0 + seconds{60}, tm), "msvzbcefhiklnoqrtuwx");
+	assert_true(!s.front());
+    }
+
+    /* Cancelled timers in two lists, at their heads too, and
+     * alone.
+     */
+    void compact(TC)
+    {
+	std::vector<std::unique_ptr<Timer>> v;
+	std::vector<Timer*> tm;
+	for (int i = 0; i < 26; i++) {
+	    v.emplace_back(new Timer {minutes{1 + i%2}});
+	    tm.push_back(v.back().get());
+	}
+
+	Lists s;
+	for (int i = 4; i < 26; i++) s.insert(t0 + seconds{i}, tm[i]);
+	for (int i = 0; i < 4; i++) s.insert(t0 + seconds{i}, tm[i]);
+	for (int i = 0; i < 26; i++) {
+	    if (i%3) v[i]->cancelled = true;
+	}
+	assert_eq(s.cancelled(), 17);
+
+	assert_eq(s.purge(), 17);
+	assert_eq(s.cancelled(), 0);
+	assert_eq(s.size(), 9);
+	v[1]->cancelled = false;
+	assert_eq(s.cancelled(), 0);
+	assert_eq(drain(s, t0 + minutes{1}, tm), "adgjmpsvy");
+	assert_true(!s.front());
+    }
+
+    void destroy(TC)
+    {
+	Timer a {minutes{1}};
+	Timer b {minutes{1}};
+	const std::vector<Timer*> tm {&a, &b};
+	{
+	    Lists s;
+	    s.insert(t0, &a);
+	    s.insert(t0 - minutes{1}, &b);
+	}
+	Lists s;
+	{
+	    Timer c {minutes{1}};
+	    s.insert(t0, &c);
+	    s.insert(t0, &a);
+	}
+	assert_eq(drain(s, t0, tm), "a");
+    }
+
+    /* A random mix of inserts, removals and pops, mostly in order
+     * per dt, against a Map.
+     */
+    void random(TC)
+    {
+	std::mt19937 rng {4711};
+	std::vector<std::unique_ptr<Timer>> v;
+	std::vector<Timer*> tm;
+	for (int i = 0; i < 26; i++) {
+	    v.emplace_back(new Timer {seconds{10 * (1 + i%3)}});
+	    tm.push_back(v.back().get());
+	}
+
+	Lists s;
+	Map m;
+	Timer* shadow[26];
+	std::vector<std::unique_ptr<Timer>> w;
+	for (int i = 0; i < 26; i++) {
+	    w.emplace_back(new Timer {tm[i]->dt});
+	    shadow[i] = w.back().get();
+	}
+	std::vector<Timer*> tw;
+	for (auto& p : w) tw.push_back(p.get());
+
+	auto now = t0;
+	for (int n = 0; n < 20000; n++) {
+	    const unsigned i = rng() % 26;
+	    switch (rng() % 4) {
+	    case 0:
+	    case 1: {
+		const auto t = now + tm[i]->dt - seconds{rng() % 8 == 0 ? 25 : 0};
+		s.insert(t, tm[i]);
+		m.insert(t, shadow[i]);
+		break;
+	    }
+	    case 2:
+		s.remove(tm[i]);
+		m.remove(shadow[i]);
+		break;
+	    default:
+		now += seconds{rng() % 5};
+		assert_eq(drain(s, now, tm), drain(m, now, tw));
+		break;
+	    }
+	}
+	assert_eq(drain(s, now + minutes{10}, tm), drain(m, now + minutes{10}, tw));
+    }
+
+    void clock(TC)
+    {
+	Clock clock {std::unique_ptr<Schedule>{new Lists}};
+	Timer a {seconds{30}};
+	Timer b {seconds{30}};
+	Timer c {seconds{10}, true};
+
+	clock.add(t0, &a);
+	clock.add(t0 + seconds{5}, &b);
+	clock.add(t0, &c);
+
+	auto res = clock.set(t0 + seconds{40});
+	assert_eq(res.elapsed.size(), 6);
+	assert_true(res.elapsed[2] == &a);
+	assert_true(res.elapsed[4] == &b);
+	assert_true(res.snooze == seconds{10});
+    }
+}
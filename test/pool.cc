@@ -0,0 +1,72 @@
+#include <pool.h>
+#include <map.h>
+
+#include <orchis.h>
+
+#include <cstdint>
+#include <map>
+
+namespace pool {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    using showtime::Pool;
+
+    void reuse(TC)
+    {
+	Pool pool;
+	void* a = pool.allocate(40);
+	void* b = pool.allocate(40);
+	assert_true(a != b);
+	pool.deallocate(a, 40);
+	assert_true(pool.allocate(48) == a);
+	pool.deallocate(b, 40);
+	pool.deallocate(a, 48);
+    }
+
+    void sizes(TC)
+    {
+	Pool pool;
+	std::map<void*, std::size_t> seen;
+	for (std::size_t n : {0, 1, 16, 17, 255, 256, 257, 10000}) {
+	    for (int i = 0; i < 100; i++) {
+		void* p = pool.allocate(n);
+		assert_true(seen.emplace(p, n).second);
+		assert_eq(reinterpret_cast<std::uintptr_t>(p) % alignof(std::max_align_t), 0);
+	    }
+	}
+	for (const auto& kv : seen) pool.deallocate(kv.first, kv.second);
+    }
+
+    void allocator(TC)
+    {
+	Pool pool;
+	using Alloc = Pool::Allocator<std::pair<const int, int>>;
+	std::map<int, int, std::less<int>, Alloc> m {Alloc{pool}};
+	for (int i = 0; i < 10000; i++) m[i] = i*i;
+	for (int i = 0; i < 10000; i += 2) m.erase(i);
+	for (int i = 0; i < 10000; i += 2) m[i] = i;
+	assert_eq(m.size(), 10000);
+	assert_eq(m[99], 99*99);
+
+	std::map<int, int, std::less<int>, Alloc> other {Alloc{pool}};
+	other = m;
+	assert_eq(other[98], 98);
+    }
+
+    void shared(TC)
+    {
+	Pool pool;
+	showtime::Map a {pool};
+	showtime::Map b {pool};
+	showtime::Timer tm {std::chrono::seconds{1}};
+	const auto t = showtime::Clock::ref::from_time_t(1707645600);
+
+	a.insert(t, &tm);
+	b.insert(t, &tm);
+	assert_true(!a.front());
+	assert_true(b.front()->tm == &tm);
+    }
+}
@@ -0,0 +1,136 @@
+#include <runner.h>
+
+#include <orchis.h>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace runner {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    using showtime::Clock;
+    using showtime::Runner;
+    using showtime::Timer;
+
+    using std::chrono::milliseconds;
+
+    bool disarmed(const Runner& runner)
+    {
+	itimerspec its;
+	timerfd_gettime(runner.fd(), &its);
+	return !its.it_value.tv_sec && !its.it_value.tv_nsec;
+    }
+
+    void epoll(TC)
+    {
+	Clock clock;
+	Runner runner {clock};
+	const int epfd = epoll_create1(0);
+	runner.watch(epfd);
+	assert_true(disarmed(runner));
+
+	Timer a {milliseconds{20}};
+	Timer b {milliseconds{10}};
+	runner.add(&a);
+	runner.add(&b);
+	assert_true(!disarmed(runner));
+
+	std::vector<Timer*> elapsed;
+	const auto t0 = Clock::ref::now();
+	while (elapsed.size() < 2) {
+	    epoll_event ev;
+	    assert_eq(epoll_wait(epfd, &ev, 1, 1000), 1);
+	    assert_true(ev.data.ptr == &runner);
+	    runner.run(elapsed);
+	}
+	assert_true(Clock::ref::now() - t0 >= milliseconds{10});
+	assert_true(elapsed[0] == &b);
+	assert_true(elapsed[1] == &a);
+
+	assert_true(disarmed(runner));
+	epoll_event ev;
+	assert_eq(epoll_wait(epfd, &ev, 1, 0), 0);
+	close(epfd);
+    }
+
+    void dispatch(TC)
+    {
+	struct Counter : Timer {
+	    Counter() : Timer {milliseconds{1}, true} {}
+	    void fire() override { n++; }
+	    int n = 0;
+	};
+
+	Clock clock;
+	Runner runner {clock};
+	Counter a;
+	runner.add(&a);
+	while (a.n < 3) {
+	    usleep(1000);
+	    runner.run();
+	}
+	assert_true(!disarmed(runner));
+	a.cancel();
+	runner.run();
+	assert_true(disarmed(runner));
+    }
+
+    void pause(TC)
+    {
+	Clock clock;
+	Runner runner {clock};
+	Timer a {milliseconds{100}};
+	runner.add(&a);
+	assert_true(!disarmed(runner));
+
+	clock.change(clock.at(Clock::ref::now()), clock.at(Clock::ref::now()), 0);
+	std::vector<Timer*> elapsed;
+	runner.run(elapsed);
+	assert_true(disarmed(runner));
+
+	clock.change(clock.at(Clock::ref::now()), clock.at(Clock::ref::now()), 1);
+	runner.run(elapsed);
+	assert_true(!disarmed(runner));
+	assert_eq(elapsed.size(), 0);
+    }
+
+    void past(TC)
+    {
+	Clock clock;
+	Runner runner {clock};
+	const int epfd = epoll_create1(0);
+	runner.watch(epfd);
+
+	Timer a {milliseconds{1}};
+	Timer b {milliseconds{100}};
+	clock.add(Clock::time_point{} - std::chrono::hours{1}, &a);
+	runner.add(&b);
+
+	epoll_event ev;
+	assert_eq(epoll_wait(epfd, &ev, 1, 1000), 1);
+	std::vector<Timer*> elapsed;
+	runner.run(elapsed);
+	assert_eq(elapsed.size(), 1);
+	assert_true(elapsed[0] == &a);
+	close(epfd);
+    }
+
+    void remove(TC)
+    {
+	Clock clock;
+	Runner runner {clock};
+	Timer a {milliseconds{1}};
+	runner.add(&a);
+	runner.remove(&a);
+	usleep(2000);
+
+	std::vector<Timer*> elapsed;
+	runner.run(elapsed);
+	assert_eq(elapsed.size(), 0);
+	assert_true(disarmed(runner));
+    }
+}
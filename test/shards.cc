@@ -0,0 +1,85 @@
+#include <shards.h>
+
+#include <orchis.h>
+
+#include <thread>
+
+namespace shards {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    using showtime::Clock;
+    using showtime::Shards;
+    using showtime::Timer;
+
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    void route(TC)
+    {
+	Shards s {3};
+	Timer a {minutes{1}};
+	Timer b {minutes{1}};
+	s.add(t0, &a);
+	s.add(s.shard(&a) == 0 ? 1 : 0, t0, &b);
+
+	std::vector<Timer*> elapsed;
+	for (unsigned i = 0; i < s.size(); i++) {
+	    s.set(i, t0 + minutes{1}, elapsed);
+	    if (i == s.shard(&a)) {
+		assert_true(!elapsed.empty() && elapsed.back() == &a);
+	    }
+	}
+	assert_eq(elapsed.size(), 2);
+    }
+
+    void change(TC)
+    {
+	Shards s {2};
+	s.change(t0, t0 + hours{1}, 1);
+	const auto now = t0 - minutes{5};
+	assert_true(s.at(now) == now + hours{1});
+	assert_true(s.clock(1).at(now) == now + hours{1});
+	s.change(t0, t0 - hours{1}, 1);
+	assert_true(s.at(now) == now);
+	assert_true(s.clock(0).at(now) == now);
+    }
+
+    void threads(TC)
+    {
+	const unsigned n = 4;
+	const unsigned m = 20000;
+	Shards s {n};
+	std::vector<std::unique_ptr<Timer>> timers;
+	for (unsigned i = 0; i < m; i++) {
+	    timers.emplace_back(new Timer {minutes{1 + i%60}});
+	}
+
+	std::atomic<bool> done {false};
+	std::vector<std::vector<Timer*>> elapsed(n);
+	std::vector<std::thread> threads;
+	for (unsigned i = 0; i < n; i++) {
+	    threads.emplace_back([&s, &done, &elapsed, i] {
+		while (!done) s.set(i, t0, elapsed[i]);
+		s.set(i, t0 + hours{1}, elapsed[i]);
+	    });
+	}
+	for (auto& tm : timers) s.add(t0, tm.get());
+	s.change(t0, t0 + hours{1}, 1);
+	done = true;
+	for (auto& th : threads) th.join();
+
+	unsigned total = 0;
+	for (unsigned i = 0; i < n; i++) {
+	    for (Timer* tm : elapsed[i]) assert_eq(s.shard(tm), i);
+	    total += elapsed[i].size();
+	    assert_true(s.clock(i).at(t0) == t0 + hours{1});
+	}
+	assert_eq(total, m);
+    }
+}
@@ -1,7 +1,12 @@
 #include <showtime.h>
+#include <wheel.h>
 
 #include <orchis.h>
 
+#include <map>
+#include <functional>
+#include <limits>
+
 /* For testing (and reasoning about showtime::Clock in general) let's
  * imagine a Sunday morning, from 10:00 onwards.
  *
@@ -20,6 +25,7 @@
 
 namespace {
 
+    using std::chrono::hours;
     using std::chrono::minutes;
     using std::chrono::seconds;
 
@@ -76,6 +82,41 @@ namespace {
 	orchis::assert_eq(s, elapsed);
 	orchis::assert_eq(res.snooze.count(), snooze.count());
     }
+
+    /* A timer which, when it fires, writes its name and maybe does
+     * something else.
+     */
+    struct Named : showtime::Timer {
+	Named(std::string& log, char name, minutes dt, bool repeat = false)
+	    : Timer {dt, repeat},
+	      log(log),
+	      name {name}
+	{}
+	void fire() override {
+	    log.push_back(name);
+	    if (then) then();
+	}
+	std::string& log;
+	const char name;
+	std::function<void ()> then;
+    };
+
+    /* A Wheel, counting what the Clock asks of it.
+     */
+    struct Counting : showtime::Wheel {
+	unsigned inserts = 0;
+	unsigned pops = 0;
+
+	void insert(time_point t, showtime::Timer* tm) override {
+	    inserts++;
+	    Wheel::insert(t, tm);
+	}
+	bool pop(time_point t, Entry& e) override {
+	    const bool popped = Wheel::pop(t, e);
+	    pops += popped;
+	    return popped;
+	}
+    };
 }
 
 namespace showtime {
@@ -166,6 +207,523 @@ namespace showtime {
 	assert_res(res, "C", minutes{10});
     }
 
+    void cancel_early(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+
+	auto assert_res = [&timers] (const Clock::Ramifications& res,
+				     const char* elapsed, Clock::duration snooze) {
+	    assert_eq(timers, res, elapsed, snooze);
+	};
+
+	auto res = clock.set(sun.at("10:20"));
+	assert_res(res, "ABA", minutes{5});
+
+	timers.A.cancel();
+	timers.A.cancel();
+
+	res = clock.set(sun.at("10:20"));
+	assert_res(res, "", minutes{10});
+
+	timers.C.cancel();
+	res = clock.set(sun.at("10:35"));
+	assert_res(res, "", minutes{10});
+
+	timers.D.cancel();
+	res = clock.set(sun.at("10:35"));
+	assert_res(res, "", minutes{60});
+    }
+
+    void sweep(TC)
+    {
+	showtime::Wheel* const wheel = new showtime::Wheel;
+	Clock clock {std::unique_ptr<showtime::Schedule> {wheel}};
+	std::vector<std::unique_ptr<Timer>> v;
+	for (unsigned i = 0; i < 200; i++) {
+	    v.emplace_back(new Timer {minutes{1 + i}});
+	    clock.add(sun.at("10:00"), v.back().get());
+	}
+
+	for (unsigned i = 0; i < 100; i++) v[i]->cancelled = true;
+	v[0]->cancelled = false;
+	v[1]->cancel();
+	orchis::assert_eq(wheel->cancelled(), 98);
+	orchis::assert_eq(wheel->size(), 199);
+
+	Timer again {minutes{1}};
+	clock.add(sun.at("10:00"), &again);
+	orchis::assert_eq(wheel->cancelled(), 98);
+	orchis::assert_eq(wheel->size(), 200);
+
+	for (unsigned i = 100; i < 103; i++) v[i]->cancelled = true;
+	clock.add(sun.at("10:00"), &again);
+	orchis::assert_eq(wheel->cancelled(), 0);
+	orchis::assert_eq(wheel->size(), 99);
+
+	v.resize(150);
+	orchis::assert_eq(wheel->size(), 49);
+	auto res = clock.set(sun.at("10:01"));
+	orchis::assert_eq(res.elapsed.size(), 2);
+    }
+
+    /* The sweep happens on set() too, and in the Map.
+     */
+    void sweep_set(TC)
+    {
+	Clock clock;
+	clock.instrument(true);
+	std::vector<std::unique_ptr<Timer>> v;
+	for (unsigned i = 0; i < 100; i++) {
+	    v.emplace_back(new Timer {minutes{1 + i}});
+	    clock.add(sun.at("10:00"), v.back().get());
+	}
+	for (unsigned i = 0; i < 100; i++) {
+	    if (i%2==0 || i < 40) v[i]->cancelled = true;
+	}
+
+	auto res = clock.set(sun.at("10:00"));
+	orchis::assert_eq(res.elapsed.size(), 0);
+	auto s = clock.stats();
+	orchis::assert_eq(s.swept, 70);
+	orchis::assert_eq(s.skipped, 0);
+	orchis::assert_eq(s.cancelled, 0);
+	orchis::assert_eq(s.size, 30);
+
+	res = clock.set(sun.at("11:40"));
+	orchis::assert_eq(res.elapsed.size(), 30);
+	assert_true(res.elapsed[0] == v[41].get());
+	assert_true(res.elapsed[29] == v[99].get());
+    }
+
+    void list(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+
+	std::vector<Clock::Entry> v;
+	clock.list(v);
+	orchis::assert_eq(v.size(), 4);
+	assert_true(v[0].tm == &timers.A && v[0].t == sun.at("10:05"));
+	assert_true(v[3].tm == &timers.D && v[3].t == sun.at("10:45"));
+
+	Clock other;
+	other.insert(v.data(), v.data() + v.size());
+	auto res = other.set(sun.at("10:20"));
+	assert_eq(timers, res, "ABA", minutes{5});
+    }
+
+    void remove(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+
+	auto assert_res = [&timers] (const Clock::Ramifications& res,
+				     const char* elapsed, Clock::duration snooze) {
+	    assert_eq(timers, res, elapsed, snooze);
+	};
+
+	clock.remove(&timers.B);
+	clock.remove(&timers.B);
+
+	auto res = clock.set(sun.at("10:20"));
+	assert_res(res, "AA", minutes{5});
+
+	clock.remove(&timers.A);
+
+	res = clock.set(sun.at("10:40"));
+	assert_res(res, "C", minutes{5});
+    }
+
+    void rearm(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+	timers.A.cancelled = true;
+
+	auto assert_res = [&timers] (const Clock::Ramifications& res,
+				     const char* elapsed, Clock::duration snooze) {
+	    assert_eq(timers, res, elapsed, snooze);
+	};
+
+	clock.add(sun.at("10:10"), &timers.B);
+
+	auto res = clock.set(sun.at("10:20"));
+	assert_res(res, "", minutes{5});
+
+	res = clock.set(sun.at("10:30"));
+	assert_res(res, "BC", minutes{15});
+    }
+
+    void destroy(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+	{
+	    Timer E {minutes{5}};
+	    clock.add(sun.at("10:00"), &E);
+	}
+
+	auto res = clock.set(sun.at("10:10"));
+	assert_eq(timers, res, "A", minutes{5});
+    }
+
+    void coalesce(TC)
+    {
+	Clock clock;
+	clock.coalesce(true);
+	Mix timers;
+	prepare(clock, timers);
+	clock.remove(&timers.B);
+	clock.remove(&timers.D);
+
+	auto assert_res = [&timers] (const Clock::Ramifications& res,
+				     const char* elapsed, Clock::duration snooze) {
+	    assert_eq(timers, res, elapsed, snooze);
+	};
+
+	auto res = clock.set(sun.at("10:10"));
+	assert_res(res, "A", minutes{5});
+	orchis::assert_eq(timers.A.overrun, 0);
+
+	res = clock.set(sun.at("10:40"));
+	assert_res(res, "AC", minutes{5});
+	orchis::assert_eq(timers.A.overrun, 2);
+
+	res = clock.set(sun.at("10:45"));
+	assert_res(res, "A", minutes{10});
+	orchis::assert_eq(timers.A.overrun, 0);
+
+	res = clock.set(sun.at("10:45") + std::chrono::hours{24*365});
+	assert_res(res, "A", minutes{10});
+	orchis::assert_eq(timers.A.overrun, 6*24*365 - 1);
+    }
+
+    void buffer(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+
+	std::vector<Timer*> acc;
+	auto snooze = clock.set(sun.at("10:10"), acc);
+	orchis::assert_eq(acc.size(), 1);
+	assert_true(acc[0] == &timers.A);
+	orchis::assert_eq(snooze.count(), Clock::duration{minutes{5}}.count());
+
+	acc.clear();
+	clock.set(sun.at("10:12"), acc);
+	orchis::assert_eq(acc.size(), 0);
+
+	acc.push_back(&timers.D);
+	clock.set(sun.at("10:33"), acc);
+	orchis::assert_eq(acc.size(), 5);
+	assert_true(acc[0] == &timers.D);
+	assert_true(acc[4] == &timers.C);
+    }
+
+    void same_time(TC)
+    {
+	Clock clock;
+	std::vector<std::unique_ptr<Timer>> timers;
+	for (int i = 0; i < 1000; i++) {
+	    timers.emplace_back(new Timer {minutes{15}});
+	    clock.add(sun.at("10:00"), timers.back().get());
+	}
+
+	auto res = clock.set(sun.at("10:15") - Clock::duration{1});
+	orchis::assert_eq(res.elapsed.size(), 0);
+	orchis::assert_eq(res.snooze.count(), 1);
+
+	res = clock.set(sun.at("10:15"));
+	orchis::assert_eq(res.elapsed.size(), 1000);
+	for (int i = 0; i < 1000; i++) {
+	    assert_true(res.elapsed[i] == timers[i].get());
+	}
+    }
+
+    void incremental(TC)
+    {
+	Counting* const w = new Counting;
+	Clock clock {std::unique_ptr<Schedule>{w}};
+	std::vector<std::unique_ptr<Timer>> timers;
+	for (int i = 0; i < 1000; i++) {
+	    timers.emplace_back(new Timer {seconds{60 + i}, true});
+	    clock.add(sun.at("10:00"), timers.back().get());
+	}
+	w->inserts = 0;
+
+	std::vector<Timer*> acc;
+	clock.set(sun.at("10:00"), acc);
+	orchis::assert_eq(w->pops, 0);
+	orchis::assert_eq(w->inserts, 0);
+
+	clock.set(sun.at("10:01"), acc);
+	orchis::assert_eq(acc.size(), 1);
+	orchis::assert_eq(w->pops, 1);
+	orchis::assert_eq(w->inserts, 1);
+
+	clock.set(sun.at("10:01") + seconds{9}, acc);
+	orchis::assert_eq(acc.size(), 10);
+	orchis::assert_eq(w->pops, 10);
+	orchis::assert_eq(w->inserts, 10);
+    }
+
+    void dispatch(TC)
+    {
+	Clock clock;
+	std::string log;
+	Named A {log, 'A', minutes{10}, true};
+	Named B {log, 'B', minutes{15}};
+	Named C {log, 'C', minutes{30}};
+	Named D {log, 'D', minutes{45}};
+	for (Timer* tm : {&A, &B, &C, &D}) clock.add(sun.at("10:00"), tm);
+
+	int n = 0;
+	A.then = [&] { if (++n==2) C.cancel(); if (n==4) A.cancel(); };
+	B.then = [&] { if (log.size() < 3) clock.add(sun.at("10:15"), &B); };
+
+	auto snooze = clock.dispatch(sun.at("10:20"));
+	orchis::assert_eq(log, "ABA");
+	orchis::assert_eq(snooze.count(), Clock::duration{minutes{10}}.count());
+
+	snooze = clock.dispatch(sun.at("11:00"));
+	orchis::assert_eq(log, "ABABAAD");
+	orchis::assert_eq(snooze.count(), Clock::duration{minutes{60}}.count());
+    }
+
+    void stats(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+	orchis::assert_eq(clock.stats().size, 4);
+	orchis::assert_eq(clock.stats().sets, 0);
+
+	clock.instrument(true);
+	clock.set(sun.at("10:00"));
+	clock.set(sun.at("10:20"));
+	timers.C.cancelled = true;
+	clock.remove(&timers.D);
+	clock.set(sun.at("11:00"));
+
+	const auto s = clock.stats();
+	orchis::assert_eq(s.sets, 3);
+	orchis::assert_eq(s.elapsed, 3 + 4);
+	orchis::assert_eq(s.repeated, 6);
+	orchis::assert_eq(s.skipped, 1);
+	orchis::assert_eq(s.removed, 1);
+	orchis::assert_eq(s.size, 1);
+	orchis::assert_eq(s.batch[0], 1);
+	orchis::assert_eq(s.batch[2], 1);
+	orchis::assert_eq(s.batch[3], 1);
+	unsigned long n = 0;
+	for (auto k : s.latency) n += k;
+	orchis::assert_eq(n, 3);
+
+	clock.instrument(false);
+	clock.set(sun.at("12:00"));
+	orchis::assert_eq(clock.stats().sets, 0);
+    }
+
+    void stats_removed(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+	clock.instrument(true);
+
+	clock.remove(&timers.B);
+	clock.remove(&timers.B);
+	timers.C.cancel();
+	timers.C.cancel();
+	timers.D.cancelled = true;
+
+	auto s = clock.stats();
+	orchis::assert_eq(s.removed, 2);
+	orchis::assert_eq(s.size, 2);
+	orchis::assert_eq(s.cancelled, 1);
+
+	clock.set(sun.at("10:50"));
+	s = clock.stats();
+	orchis::assert_eq(s.skipped, 1);
+	orchis::assert_eq(s.cancelled, 0);
+	orchis::assert_eq(s.size, 1);
+    }
+
+    void elapsing(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+
+	std::string s;
+	for (Timer* tm : clock.elapsing(sun.at("11:00"))) {
+	    s.push_back('A' + (tm == &timers.B) + 2*(tm == &timers.C) + 3*(tm == &timers.D));
+	    if (s.size()==4) break;
+	}
+	orchis::assert_eq(s, "ABAA");
+
+	auto res = clock.set(sun.at("11:00"));
+	assert_eq(timers, res, "CADAA", minutes{5});
+
+	unsigned n = 0;
+	for (Timer* tm : clock.elapsing(sun.at("11:00") + hours{24})) {
+	    assert_true(tm == &timers.A);
+	    n++;
+	}
+	orchis::assert_eq(n, 144);
+    }
+
+    void elapsing_stats(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+	clock.instrument(true);
+
+	{
+	    auto range = clock.elapsing(sun.at("10:30"));
+	    unsigned n = 0;
+	    for (auto it = range.begin(); it != range.end(); ++it) n++;
+	    orchis::assert_eq(n, 5);
+	    orchis::assert_eq(clock.stats().sets, 0);
+	}
+	auto s = clock.stats();
+	orchis::assert_eq(s.sets, 1);
+	orchis::assert_eq(s.elapsed, 5);
+	orchis::assert_eq(s.batch[3], 1);
+
+	for (Timer* tm : clock.elapsing(sun.at("11:00"))) {
+	    if (tm == &timers.D) break;
+	}
+	s = clock.stats();
+	orchis::assert_eq(s.sets, 2);
+	orchis::assert_eq(s.batch[2], 1);
+    }
+
+    void bounded(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+
+	Clock::Ramifications res;
+	res.snooze = clock.set(sun.at("11:00"), res.elapsed, 4);
+	assert_eq(timers, res, "ABAA", minutes{0});
+	res.elapsed.clear();
+	res.snooze = clock.set(sun.at("11:00"), res.elapsed, 4);
+	assert_eq(timers, res, "CADA", minutes{0});
+	res.elapsed.clear();
+	res.snooze = clock.set(sun.at("11:00"), res.elapsed, 4);
+	assert_eq(timers, res, "A", minutes{5});
+	res.elapsed.clear();
+	res.snooze = clock.set(sun.at("11:00"), res.elapsed, 0);
+	assert_eq(timers, res, "", minutes{5});
+    }
+
+    /* Only a cancelled timer left due by t, and a max of 0.
+     */
+    void bounded_rest(TC)
+    {
+	Clock clock;
+	Timer X {minutes{15}};
+	Timer Y {minutes{15}};
+	clock.add(sun.at("10:00"), &X);
+	clock.add(sun.at("10:00"), &Y);
+	Y.cancelled = true;
+
+	std::vector<Timer*> elapsed;
+	auto snooze = clock.set(sun.at("10:15"), elapsed, 1);
+	assert_true(elapsed.size()==1 && elapsed[0]==&X);
+	assert_true(snooze == hours{1});
+	orchis::assert_eq(clock.stats().cancelled, 0);
+
+	elapsed.clear();
+	clock.add(sun.at("10:00"), &X);
+	snooze = clock.set(sun.at("10:15"), elapsed, 0);
+	assert_true(elapsed.size()==1 && elapsed[0]==&X);
+	assert_true(snooze == hours{1});
+    }
+
+    void bounded_dispatch(TC)
+    {
+	Clock clock;
+	std::string log;
+	Named A {log, 'A', minutes{10}, true};
+	Named B {log, 'B', minutes{15}};
+	clock.add(sun.at("10:00"), &A);
+	clock.add(sun.at("10:00"), &B);
+
+	auto snooze = clock.dispatch(sun.at("10:20"), 2);
+	orchis::assert_eq(log, "AB");
+	orchis::assert_eq(snooze.count(), 0);
+	snooze = clock.dispatch(sun.at("10:20"), 2);
+	orchis::assert_eq(log, "ABA");
+	orchis::assert_eq(snooze.count(), Clock::duration{minutes{10}}.count());
+    }
+
+    void batch(TC)
+    {
+	Clock clock;
+	Mix timers;
+	Timer E {minutes{15}};
+	clock.add(sun.at("10:00"), &timers.C);
+
+	const std::vector<Timer*> batch {&timers.D, &timers.B, &E, &timers.C};
+	auto snooze = clock.add(sun.at("10:00"), begin(batch), end(batch));
+	orchis::assert_eq(snooze.count(), Clock::duration{minutes{15}}.count());
+
+	Timer* const a[] = {&timers.A};
+	snooze = clock.add(sun.at("09:55"), a, a+1);
+	orchis::assert_eq(snooze.count(), Clock::duration{minutes{10}}.count());
+
+	auto res = clock.set(sun.at("10:30"));
+	orchis::assert_eq(res.elapsed.size(), 6);
+	assert_true(res.elapsed[1] == &timers.B);
+	assert_true(res.elapsed[2] == &E);
+	assert_true(res.elapsed[5] == &timers.C);
+
+	res = clock.set(sun.at("10:45"));
+	assert_eq(timers, res, "ADA", minutes{10});
+    }
+
+    void slack(TC)
+    {
+	Clock clock;
+	clock.slack(minutes{10});
+	Mix timers;
+	prepare(clock, timers);
+
+	auto assert_res = [&timers] (const Clock::Ramifications& res,
+				     const char* elapsed, Clock::duration snooze) {
+	    assert_eq(timers, res, elapsed, snooze);
+	};
+
+	auto res = clock.set(sun.at("10:00"));
+	assert_res(res, "", minutes{10});
+
+	res = clock.set(sun.at("10:10"));
+	assert_res(res, "A", minutes{10});
+
+	res = clock.set(sun.at("10:20"));
+	assert_res(res, "BA", minutes{10});
+
+	res = clock.set(sun.at("10:27"));
+	assert_res(res, "A", minutes{3});
+
+	clock.slack(minutes{0});
+	res = clock.set(sun.at("10:27"));
+	assert_res(res, "", minutes{3});
+	res = clock.set(sun.at("10:28"));
+	assert_res(res, "", minutes{2});
+    }
+
     void jump_back(TC)
     {
 	Clock clock;
@@ -207,11 +765,258 @@ namespace showtime {
 
 	clock.change(sun.at("10:00"), sun.at("10:00"), 2);
 	res = clock.set(sun.at("10:00"));
-	assert_res(res, minutes{30});
+	assert_res(res, minutes{15});
 
 	clock.change(sun.at("10:00"), sun.at("10:00"), 0.5);
 	res = clock.set(sun.at("10:00"));
 	assert_res(res, minutes{60});
+
+	clock.change(sun.at("10:00"), sun.at("10:00"), 0);
+	res = clock.set(sun.at("10:00"));
+	assert_true(res.snooze == Clock::duration::max());
+	assert_true(clock.deadline() == Clock::ref::time_point::max());
+    }
+
+    void pause(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+	assert_true(!clock.paused());
+
+	/* stopped at 10:12 */
+	clock.change(Linear<Clock>{Linear<Clock>{}, sun.at("10:12").time_since_epoch(), 0, 1});
+	assert_true(clock.paused());
+	assert_true(clock.at(sun.at("17:00")) == sun.at("10:12"));
+
+	auto res = clock.set(clock.at(sun.at("17:00")));
+	assert_eq(timers, res, "A", Clock::duration::max());
+	res = clock.set(clock.at(sun.at("18:00")));
+	assert_eq(timers, res, "", Clock::duration::max());
+	assert_true(clock.deadline() == Clock::ref::time_point::max());
+
+	/* running again, from 10:12 at 18:00 */
+	clock.change(Linear<Clock>{Linear<Clock>{}, sun.at("10:12") - sun.at("18:00"), 1, 1});
+	assert_true(!clock.paused());
+	assert_true(clock.deadline() == sun.at("18:03"));
+	res = clock.set(clock.at(sun.at("18:03")));
+	assert_eq(timers, res, "BA", minutes{10});
+    }
+
+    /* Setting a paused clock again doesn't look at the schedule,
+     * until there are new timers.
+     */
+    void pause_idle(TC)
+    {
+	struct Spy : showtime::Wheel {
+	    const Entry* front() override { n++; return Wheel::front(); }
+	    bool pop(time_point t, Entry& e) override { n++; return Wheel::pop(t, e); }
+	    unsigned n = 0;
+	};
+	Spy* const spy = new Spy;
+	Clock clock {std::unique_ptr<showtime::Schedule> {spy}};
+	Mix timers;
+	prepare(clock, timers);
+
+	clock.change(Linear<Clock>{Linear<Clock>{}, sun.at("10:12").time_since_epoch(), 0, 1});
+	auto res = clock.set(sun.at("10:12"));
+	assert_eq(timers, res, "A", Clock::duration::max());
+	assert_true(spy->n > 0);
+
+	spy->n = 0;
+	res = clock.set(sun.at("10:12"));
+	assert_eq(timers, res, "", Clock::duration::max());
+	std::vector<Timer*> elapsed;
+	assert_true(clock.set(sun.at("10:12"), elapsed, 1) == Clock::duration::max());
+	assert_true(clock.dispatch(sun.at("10:12")) == Clock::duration::max());
+	orchis::assert_eq(spy->n, 0);
+
+	Timer E {minutes{0}};
+	clock.add(sun.at("10:12"), &E);
+	res = clock.set(sun.at("10:12"));
+	assert_true(res.elapsed.size()==1 && res.elapsed[0]==&E);
+	assert_true(spy->n > 0);
+    }
+
+    void backwards(TC)
+    {
+	Clock clock;
+	Mix timers;
+	prepare(clock, timers);
+	clock.change(Linear<Clock>{Linear<Clock>{}, 2*sun.at("10:12").time_since_epoch(), -1, 1});
+	assert_true(!clock.paused());
+	assert_true(clock.deadline() == Clock::ref::time_point::max());
+	auto res = clock.set(sun.at("10:12"));
+	assert_eq(timers, res, "A", Clock::duration::max());
+    }
+
+    void deadline(TC)
+    {
+	Clock clock;
+	std::vector<Timer*> acc;
+	assert_true(clock.set_until(sun.at("10:00"), acc) == Clock::ref::time_point::max());
+
+	Timer A {minutes{30}};
+	clock.add(sun.at("10:00"), &A);
+	const auto t = clock.at(sun.at("10:00"));
+	assert_true(clock.deadline() == sun.at("10:30"));
+	assert_true(clock.when(t) == sun.at("10:00"));
+
+	/* clock at 2x, showing 10:00 at reference 10:00 */
+	const auto ten = sun.at("10:00").time_since_epoch();
+	clock.change(Linear<Clock>{Linear<Clock>{}, ten - 2*ten, 2, 1});
+	assert_true(clock.at(sun.at("10:00")) == sun.at("10:00"));
+	assert_true(clock.deadline() == sun.at("10:15"));
+	assert_true(clock.set_until(sun.at("10:20"), acc) == sun.at("10:15"));
+	assert_true(clock.set_until(sun.at("10:30"), acc) == Clock::ref::time_point::max());
+	orchis::assert_eq(acc.size(), 1);
+
+	/* a third: the deadline is rounded up to the nanosecond */
+	clock.change(Linear<Clock>{Linear<Clock>{}, ten - ten/3, 1, 3});
+	clock.add(sun.at("10:00"), &A);
+	const auto d = clock.deadline();
+	assert_true(clock.at(d) >= sun.at("10:30"));
+	assert_true(clock.at(d - Clock::duration{1}) < sun.at("10:30"));
+    }
+
+    namespace linear {
+
+	using L = Linear<Clock>;
+	const Clock::time_point t = sun.at("10:00") + Clock::duration{123456789};
+
+	void identity(TC)
+	{
+	    const L f;
+	    assert_true(f(t) == t);
+	    const L g {f, hours{1}, 1};
+	    assert_true(g(t) == t + hours{1});
+	    assert_true(g(minutes{5}) == minutes{5});
+	}
+
+	void integral(TC)
+	{
+	    const L f {L{}, Clock::duration{0}, 2};
+	    orchis::assert_eq(f(t).time_since_epoch().count(),
+			      2 * t.time_since_epoch().count());
+	    const L g {f, minutes{1}, 0};
+	    assert_true(g(t) == Clock::time_point{minutes{1}});
+	    assert_true(g(minutes{5}) == minutes{0});
+	}
+
+	void fractional(TC)
+	{
+	    const L f {L{}, Clock::duration{0}, 0.5};
+	    orchis::assert_eq(f(t).time_since_epoch().count(),
+			      t.time_since_epoch().count() / 2);
+	    const L g {L{}, Clock::duration{0}, 0.1};
+	    assert_true(g(seconds{10}) == seconds{1});
+	    const L h {L{}, Clock::duration{0}, 1.0/3};
+	    assert_true(h(minutes{3}) == minutes{1});
+	}
+
+	void fixed(TC)
+	{
+	    using std::ratio;
+	    using T = Clock::time_point;
+
+	    constexpr Offset<Clock> f {hours{1}};
+	    static_assert(f(minutes{5}) == minutes{5}, "");
+	    static_assert(f(T{hours{2}}) == T{hours{3}}, "");
+	    constexpr Offset<Clock> g {f, -hours{1}};
+	    static_assert(g(T{hours{2}}) == T{hours{2}}, "");
+
+	    constexpr Linear<Clock, ratio<2>> twice {minutes{1}};
+	    static_assert(twice(T{hours{2}}) == T{hours{4} + minutes{1}}, "");
+	    static_assert(Linear<Clock, ratio<1, 3>>{}(minutes{3}) == minutes{1}, "");
+	    static_assert(Linear<Clock, ratio<0>>{}(minutes{3}) == minutes{0}, "");
+
+	    constexpr L id;
+	    static_assert(id(T{hours{2}}) == T{hours{2}}, "");
+	    constexpr L half {id, minutes{1}, 1, 2};
+	    static_assert(half(T{hours{2}}) == T{hours{1} + minutes{1}}, "");
+
+	    assert_true(f(t) == t + hours{1});
+	}
+
+	void inverse(TC)
+	{
+	    using std::ratio;
+	    using T = Clock::time_point;
+
+	    static_assert(Offset<Clock>{hours{1}}.inverse(T{hours{3}}) == T{hours{2}}, "");
+	    static_assert(Linear<Clock, ratio<2>>{}.inverse(minutes{3}) == seconds{90}, "");
+	    static_assert(Linear<Clock, ratio<0>>{}.inverse(minutes{3}) == Clock::duration::max(), "");
+	    static_assert(L{L{}, minutes{0}, 3, 1}.inverse(Clock::duration{7}) == Clock::duration{3}, "");
+	    static_assert(L{L{}, minutes{0}, 3, 1}.inverse(Clock::duration{-7}) == Clock::duration{-2}, "");
+	    static_assert(L{L{}, minutes{0}, 1, 1000}.inverse(Clock::duration::max()) == Clock::duration::max(), "");
+
+	    for (double k : {1.0, 2.0, 3.0, 0.5, 0.75, 1.7}) {
+		const L f {L{}, hours{-24*365*50}, k};
+		for (int i = 0; i < 100; i++) {
+		    const auto y = t + i*Clock::duration{7777777};
+		    const auto x = f.inverse(y);
+		    assert_true(f(x) >= y);
+		    assert_true(f(x - Clock::duration{1}) < y);
+		}
+	    }
+
+	    const L stopped {L{}, hours{1}, 0};
+	    assert_true(stopped.inverse(t) == T::max());
+
+	    std::vector<Clock::time_point> v {t, t + hours{1}, t - seconds{1}};
+	    std::vector<Clock::time_point> w(v.size());
+	    for (double k : {1.0, 0.5}) {
+		const L f {L{}, hours{3}, k};
+		f.inverse(v.data(), v.data() + v.size(), w.data());
+		for (unsigned i = 0; i < v.size(); i++) assert_true(w[i] == f.inverse(v[i]));
+	    }
+	}
+
+	void batch(TC)
+	{
+	    std::vector<Clock::time_point> v;
+	    for (int i = 0; i < 1000; i++) v.push_back(t + i*Clock::duration{7777777});
+	    std::vector<Clock::time_point> w(v.size());
+	    const Clock::time_point* a = v.data();
+
+	    for (double k : {1.0, 0.0, 2.0, 3.0, 0.5, 0.1, -1.0}) {
+		const L f {L{}, hours{-24*365*50}, k};
+		f(a, a + v.size(), w.data());
+		for (unsigned i = 0; i < v.size(); i++) assert_true(w[i] == f(v[i]));
+	    }
+
+	    Clock clock;
+	    clock.change(t, t + hours{1}, 1);
+	    clock.at(a, a + v.size(), w.data());
+	    for (unsigned i = 0; i < v.size(); i++) assert_true(w[i] == clock.at(v[i]));
+	}
+
+	void rational(TC)
+	{
+	    auto assert_ratio = [] (double v, long long num, long long den) {
+		long long a, b;
+		showtime::rational(v, a, b);
+		orchis::assert_eq(a, num);
+		orchis::assert_eq(b, den);
+	    };
+	    assert_ratio(0, 0, 1);
+	    assert_ratio(1, 1, 1);
+	    assert_ratio(2, 2, 1);
+	    assert_ratio(0.5, 1, 2);
+	    assert_ratio(0.1, 1, 10);
+	    assert_ratio(2.0/3, 2, 3);
+	    assert_ratio(-1.5, -3, 2);
+	    assert_ratio(1e-20, 0, 1);
+	    assert_ratio(1e20, 1LL << 40, 1);
+	    assert_ratio(std::numeric_limits<double>::quiet_NaN(), 0, 1);
+	    assert_ratio(std::numeric_limits<double>::infinity(), 1LL << 40, 1);
+	    assert_ratio(-std::numeric_limits<double>::infinity(), -(1LL << 40), 1);
+
+	    Clock clock;
+	    clock.change(Clock::time_point{}, Clock::time_point{},
+			 std::numeric_limits<double>::quiet_NaN());
+	    assert_true(clock.paused());
+	}
     }
 
     namespace norepeat {
@@ -0,0 +1,110 @@
+#include <sim.h>
+
+#include <orchis.h>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Linear;
+    using showtime::Sim;
+    using showtime::Timer;
+
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    /* Speed k, showing 'shows' at reference time 'ref'. */
+    Linear<Clock> mapping(Clock::time_point ref, Clock::time_point shows, long k)
+    {
+	return {Linear<Clock>{}, shows.time_since_epoch() - k*ref.time_since_epoch(), k, 1};
+    }
+}
+
+namespace sim {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void empty(TC)
+    {
+	Clock clock;
+	Sim sim {clock, t0};
+	unsigned n = 0;
+	auto f = [&n] (Clock::ref::time_point, const std::vector<Timer*>&) { n++; };
+	assert_eq(sim.run(t0 + hours{1}, f), 0);
+	assert_true(sim.now() == t0 + hours{1});
+	assert_eq(sim.run(Clock::ref::time_point::max(), f), 0);
+	assert_eq(n, 0);
+    }
+
+    void day(TC)
+    {
+	Clock clock;
+	Sim sim {clock, t0};
+	Timer A {minutes{10}, true};
+	Timer B {minutes{15}};
+	clock.add(clock.at(t0), &A);
+	clock.add(clock.at(t0), &B);
+
+	std::vector<Clock::ref::time_point> steps;
+	unsigned a = 0;
+	unsigned b = 0;
+	auto f = [&] (Clock::ref::time_point now, const std::vector<Timer*>& v) {
+	    steps.push_back(now);
+	    for (Timer* tm : v) { a += tm==&A; b += tm==&B; }
+	};
+	assert_eq(sim.run(t0 + hours{24}, f), 145);
+	assert_eq(a, 144);
+	assert_eq(b, 1);
+	assert_true(steps[0] == t0 + minutes{10});
+	assert_true(steps[1] == t0 + minutes{15});
+	assert_true(steps[2] == t0 + minutes{20});
+	assert_true(steps.back() == t0 + hours{24});
+	assert_true(sim.now() == t0 + hours{24});
+	assert_true(clock.deadline() == t0 + hours{24} + minutes{10});
+    }
+
+    void speed(TC)
+    {
+	Clock clock;
+	clock.change(mapping(t0, t0, 4));
+	Sim sim {clock, t0};
+	Timer A {minutes{20}, true};
+	clock.add(clock.at(t0), &A);
+
+	std::vector<Clock::ref::time_point> steps;
+	auto f = [&] (Clock::ref::time_point now, const std::vector<Timer*>& v) {
+	    assert_eq(v.size(), 1);
+	    steps.push_back(now);
+	    if (steps.size()==2) clock.change(mapping(now, clock.at(now), 0));
+	};
+	assert_eq(sim.run(t0 + hours{1}, f), 2);
+	assert_true(steps[0] == t0 + minutes{5});
+	assert_true(steps[1] == t0 + minutes{10});
+	assert_true(sim.now() == t0 + hours{1});
+    }
+
+    void dispatch(TC)
+    {
+	struct Chain : Timer {
+	    Chain(Clock& c, Sim& sim) : Timer {seconds{1}}, c(c), sim(sim) {}
+	    void fire() override { if (++n < 1000) c.add(c.at(sim.now()), this); }
+	    Clock& c;
+	    Sim& sim;
+	    int n = 0;
+	};
+
+	Clock clock;
+	Sim sim {clock, t0};
+	Chain tm {clock, sim};
+	clock.add(clock.at(t0), &tm);
+
+	assert_eq(sim.dispatch(t0 + hours{1}), 1000);
+	assert_eq(tm.n, 1000);
+	assert_true(sim.now() == t0 + hours{1});
+    }
+}
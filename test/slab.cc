@@ -0,0 +1,138 @@
+#include <slab.h>
+
+#include <orchis.h>
+
+#include <random>
+#include <map>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Slab;
+    using showtime::Timer;
+
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+}
+
+namespace slab {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void empty(TC)
+    {
+	Slab s;
+	std::vector<Slab::Id> v;
+	assert_true(s.set(t0, v) == hours{1});
+	assert_eq(v.size(), 0);
+	Clock::time_point t;
+	assert_true(!s.next(t));
+	assert_true(s.deadline() == Clock::ref::time_point::max());
+    }
+
+    void walkthrough(TC)
+    {
+	Slab s;
+	const auto A = s.add(t0 - minutes{5}, minutes{10}, true);
+	const auto B = s.add(t0, minutes{15});
+	const auto C = s.add(t0, minutes{30});
+	const auto D = s.add(t0, minutes{45});
+
+	std::vector<Slab::Id> v;
+	auto snooze = s.set(t0 + minutes{20}, v);
+	assert_true(v == std::vector<Slab::Id>({A, B, A}));
+	assert_true(snooze == minutes{5});
+	assert_true(!s.active(B));
+	assert_true(s.active(A));
+
+	s.cancel(C);
+	s.cancel(C);
+	s.cancel(B);
+	v.clear();
+	snooze = s.set(t0 + minutes{45}, v);
+	assert_true(v == std::vector<Slab::Id>({A, A, D, A}));
+	assert_true(snooze == minutes{10});
+	assert_eq(s.size(), 1);
+    }
+
+    void reuse(TC)
+    {
+	Slab s;
+	const auto a = s.add(t0, minutes{1});
+	s.cancel(a);
+	const auto b = s.add(t0, minutes{2});
+	assert_true(a != b);
+	assert_true(Slab::Id{std::uint32_t(a)} == std::uint32_t(b));
+	s.cancel(a);
+	assert_true(s.active(b));
+	assert_eq(s.size(), 1);
+    }
+
+    void speed(TC)
+    {
+	Slab s;
+	s.add(t0, minutes{30});
+	s.change(t0, t0, 2);
+	std::vector<Slab::Id> v;
+	assert_true(s.set(t0, v) == minutes{15});
+	s.change(t0, t0, 0);
+	assert_true(s.set(t0, v) == Clock::ref::duration::max());
+    }
+
+    /* Against a Clock with the same timers. */
+    void random(TC)
+    {
+	std::mt19937 rng {4711};
+	Slab s;
+	Clock clock;
+	std::vector<std::unique_ptr<Timer>> timers;
+	std::map<Slab::Id, Timer*> ids;
+	std::map<Timer*, Slab::Id> back;
+
+	auto now = t0;
+	for (int n = 0; n < 20000; n++) {
+	    switch (rng() % 4) {
+	    case 0:
+	    case 1: {
+		const auto dt = seconds{rng() % 30};
+		const bool repeat = rng() % 4 == 0;
+		timers.emplace_back(new Timer {dt, repeat});
+		clock.add(now, timers.back().get());
+		const auto id = s.add(now, dt, repeat);
+		ids[id] = timers.back().get();
+		back[timers.back().get()] = id;
+		break;
+	    }
+	    case 2:
+		if (!ids.empty()) {
+		    auto it = ids.begin();
+		    std::advance(it, rng() % ids.size());
+		    s.cancel(it->first);
+		    clock.remove(it->second);
+		    ids.erase(it);
+		}
+		break;
+	    default: {
+		now += seconds{rng() % 5};
+		std::vector<Slab::Id> v;
+		std::vector<Timer*> w;
+		s.set(now, v);
+		clock.set(now, w);
+		assert_eq(v.size(), w.size());
+		for (unsigned i = 0; i < v.size(); i++) {
+		    assert_true(back.at(w[i]) == v[i]);
+		    if (!w[i]->repeat) ids.erase(v[i]);
+		}
+		assert_eq(s.size(), clock.stats().size);
+		break;
+	    }
+	    }
+	}
+    }
+}
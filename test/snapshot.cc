@@ -0,0 +1,135 @@
+#include <snapshot.h>
+#include <map.h>
+#include <wheel.h>
+#include <heap.h>
+#include <lists.h>
+
+#include <orchis.h>
+
+#include <cstring>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Schedule;
+    using showtime::Snapshot;
+    using showtime::Timer;
+
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    /* Timers, and their IDs: the index, plus a thousand.
+     */
+    struct Timers {
+	Timers() {
+	    for (unsigned i = 0; i < 200; i++) {
+		v.emplace_back(new Timer {seconds{10 * (i % 7)}, i % 5 == 0});
+	    }
+	}
+	std::uint64_t id(const Timer* tm) const {
+	    for (unsigned i = 0; i < v.size(); i++) {
+		if (v[i].get() == tm) return 1000 + i;
+	    }
+	    return 0;
+	}
+	Timer* lookup(std::uint64_t id) const {
+	    if (id < 1000 || id >= 1000 + v.size()) return nullptr;
+	    return v[id - 1000].get();
+	}
+	std::vector<std::unique_ptr<Timer>> v;
+    };
+
+    /* The IDs of what elapses, up to t. */
+    std::vector<std::uint64_t> elapsed(Clock& clock, const Timers& timers,
+				       Clock::time_point t)
+    {
+	std::vector<Timer*> acc;
+	clock.set(t, acc);
+	std::vector<std::uint64_t> v;
+	for (Timer* tm : acc) v.push_back(timers.id(tm));
+	return v;
+    }
+}
+
+namespace snapshot {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void roundtrip(TC)
+    {
+	const auto sched = [] (int i) -> Schedule* {
+	    switch (i) {
+	    case 0: return new showtime::Map;
+	    case 1: return new showtime::Wheel;
+	    case 2: return new showtime::Heap;
+	    default: return new showtime::Lists;
+	    }
+	};
+
+	for (int i = 0; i < 4; i++) {
+	    Timers a;
+	    Clock clock {std::unique_ptr<Schedule>{new showtime::Map}};
+	    clock.change(t0, t0 + hours{1}, 1.5);
+	    for (unsigned j = 0; j < a.v.size(); j++) {
+		clock.add(t0 + seconds{j % 13}, a.v[j].get());
+	    }
+	    a.v[17]->cancelled = true;
+	    a.v[18]->cancel();
+
+	    const auto buf = Snapshot::save(clock, [&a] (const Timer* tm) { return a.id(tm); });
+	    assert_eq(buf.size(), sizeof(Snapshot::Header) + 198 * sizeof(Snapshot::Record));
+
+	    Timers b;
+	    Clock other {std::unique_ptr<Schedule>{sched(i)}};
+	    assert_true(Snapshot::load(other, buf.data(), buf.size(),
+				       [&b] (std::uint64_t id) { return b.lookup(id); }));
+	    assert_true(other.at(t0) == clock.at(t0));
+	    assert_true(other.stats().size == 198);
+
+	    for (auto t = t0; t < t0 + minutes{5}; t += seconds{7}) {
+		assert_true(elapsed(clock, a, t) == elapsed(other, b, t));
+	    }
+	}
+    }
+
+    void garbage(TC)
+    {
+	Timers a;
+	Clock clock;
+	clock.add(t0, a.v[3].get());
+	clock.add(t0, a.v[4].get());
+	auto buf = Snapshot::save(clock, [&a] (const Timer* tm) { return a.id(tm); });
+	const auto lookup = [&a] (std::uint64_t id) { return a.lookup(id); };
+
+	Clock other;
+	assert_true(!Snapshot::load(other, buf.data(), buf.size() - 1, lookup));
+	assert_true(!Snapshot::load(other, buf.data(), 10, lookup));
+	buf[0] = 'S';
+	assert_true(!Snapshot::load(other, buf.data(), buf.size(), lookup));
+	assert_eq(other.stats().size, 0);
+	buf[0] = 's';
+	assert_true(Snapshot::load(other, buf.data(), buf.size(), lookup));
+	assert_eq(other.stats().size, 2);
+    }
+
+    void unknown(TC)
+    {
+	Timers a;
+	Clock clock;
+	for (unsigned j = 0; j < 10; j++) clock.add(t0, a.v[j].get());
+	const auto buf = Snapshot::save(clock, [&a] (const Timer* tm) { return a.id(tm); });
+
+	Clock other;
+	assert_true(Snapshot::load(other, buf.data(), buf.size(),
+				   [&a] (std::uint64_t id) {
+				       return id % 2 ? a.lookup(id) : nullptr;
+				   }));
+	assert_eq(other.stats().size, 5);
+    }
+}
@@ -0,0 +1,264 @@
+#include <wheel.h>
+
+#include <orchis.h>
+
+#include <algorithm>
+
+namespace {
+
+    using showtime::Clock;
+    using showtime::Schedule;
+    using showtime::Timer;
+    using showtime::Wheel;
+
+    using std::chrono::milliseconds;
+    using std::chrono::microseconds;
+    using std::chrono::seconds;
+    using std::chrono::minutes;
+    using std::chrono::hours;
+
+    /* 2024-02-11 10:00 UTC */
+    const Clock::time_point t0 = Clock::ref::from_time_t(1707645600);
+
+    /* Pop everything up to t, and name the timers in the order they
+     * came, by their index in 'tm'.
+     */
+    std::string drain(Schedule& s, Clock::time_point t,
+		      const std::vector<Timer*>& tm)
+    {
+	std::string acc;
+	Schedule::Entry e;
+	while (s.pop(t, e)) {
+	    const auto it = std::find(begin(tm), end(tm), e.tm);
+	    acc.push_back('a' + (it - begin(tm)));
+	}
+	return acc;
+    }
+}
+
+namespace wheel {
+
+    using orchis::TC;
+    using orchis::assert_eq;
+    using orchis::assert_true;
+
+    void empty(TC)
+    {
+	Wheel w;
+	assert_true(!w.front());
+	Schedule::Entry e;
+	assert_true(!w.pop(t0 + hours{24*365}, e));
+    }
+
+    void order(TC)
+    {
+	Wheel w;
+	Timer a {milliseconds{3}};
+	Timer b {seconds{2}};
+	Timer c {minutes{3}};
+	Timer d {hours{4}};
+	Timer e {hours{24*30}};
+	Timer f {milliseconds{0}};
+	const std::vector<Timer*> tm {&a, &b, &c, &d, &e, &f};
+
+	for (Timer* p : {&e, &c, &a, &d, &f, &b}) w.insert(t0 + p->dt, p);
+
+	assert_true(w.front()->tm == &f);
+	assert_eq(drain(w, t0 + hours{24*365}, tm), "fabcde");
+	assert_true(!w.front());
+    }
+
+    void same_time(TC)
+    {
+	Wheel w;
+	Timer a {minutes{5}};
+	Timer b {minutes{5}};
+	Timer c {minutes{5}};
+	const std::vector<Timer*> tm {&a, &b, &c};
+
+	w.insert(t0 + minutes{5}, &b);
+	w.insert(t0 + minutes{5}, &c);
+	w.insert(t0 + minutes{5}, &a);
+
+	assert_eq(drain(w, t0 + minutes{5}, tm), "bca");
+    }
+
+    void within_tick(TC)
+    {
+	Wheel w {minutes{10}};
+	Timer a {minutes{1}};
+	Timer b {minutes{2}};
+	Timer c {minutes{3}};
+	const std::vector<Timer*> tm {&a, &b, &c};
+
+	w.insert(t0 + minutes{3}, &c);
+	w.insert(t0 + minutes{1}, &a);
+	w.insert(t0 + minutes{2}, &b);
+
+	assert_eq(drain(w, t0 + minutes{2}, tm), "ab");
+	assert_true(w.front()->t == t0 + minutes{3});
+	assert_eq(drain(w, t0 + minutes{2} + seconds{59}, tm), "");
+	assert_eq(drain(w, t0 + minutes{3}, tm), "c");
+    }
+
+    void step(TC)
+    {
+	Wheel w;
+	Timer a {microseconds{64*64*64 + 17}};
+	Timer b {microseconds{64*64*64 + 17}};
+	const std::vector<Timer*> tm {&a, &b};
+
+	w.insert(t0 + milliseconds{64*64 + 5}, &a);
+	w.insert(t0 + milliseconds{64*64*64 + 3}, &b);
+
+	std::string s;
+	for (int i = 0; i < 64*64*64 + 10; i += 7) {
+	    const auto t = t0 + milliseconds{i};
+	    const auto ss = drain(w, t, tm);
+	    if (!ss.empty()) {
+		assert_true(w.front() == nullptr || w.front()->t > t);
+		s += ss;
+	    }
+	}
+	assert_eq(s, "ab");
+    }
+
+    void remove(TC)
+    {
+	Wheel w;
+	Timer a {milliseconds{1}};
+	Timer b {hours{1}};
+	Timer c {hours{24*100}};
+	const std::vector<Timer*> tm {&a, &b, &c};
+
+	for (Timer* p : tm) w.insert(t0 + p->dt, p);
+	w.insert(t0 + hours{2}, &a);
+	w.remove(&a);
+	assert_true(w.front()->tm == &b);
+	w.remove(&b);
+	assert_true(w.front()->tm == &c);
+
+	assert_eq(drain(w, t0 + hours{24*365}, tm), "c");
+    }
+
+    void rearm(TC)
+    {
+	Wheel w;
+	Timer a {milliseconds{1}};
+	Timer b {hours{1}};
+	const std::vector<Timer*> tm {&a, &b};
+
+	w.insert(t0 + minutes{1}, &a);
+	w.insert(t0 + minutes{2}, &b);
+	assert_eq(drain(w, t0 + minutes{1}, tm), "a");
+	w.insert(t0 + minutes{3}, &a);
+	w.insert(t0 + minutes{4}, &b);
+	w.insert(t0 + minutes{5}, &a);
+
+	assert_eq(drain(w, t0 + minutes{3}, tm), "");
+	assert_eq(drain(w, t0 + minutes{5}, tm), "ba");
+    }
+
+    void destroy(TC)
+    {
+	Timer a {milliseconds{1}};
+	const std::vector<Timer*> tm {&a};
+	Wheel w;
+	{
+	    Timer b {milliseconds{1}};
+	    w.insert(t0, &b);
+	    w.insert(t0, &a);
+	}
+	assert_eq(drain(w, t0, tm), "a");
+	w.insert(t0, &a);
+    }
+
+    void cancel(TC)
+    {
+	Wheel w;
+	std::vector<Timer*> tm;
+	std::vector<std::unique_ptr<Timer>> v;
+	for (int i = 0; i < 20; i++) {
+	    v.emplace_back(new Timer {minutes{i}});
+	    tm.push_back(v.back().get());
+	    w.insert(t0 + v.back()->dt, v.back().get());
+	}
+	for (int i = 0; i < 20; i++) {
+	    if (i != 2 && i != 7) v[i]->cancel();
+	}
+	v[7]->cancel();
+	w.insert(t0, v[7].get());
+	assert_eq(drain(w, t0 + hours{1}, tm), "hc");
+    }
+
+    /* Cancelled timers all over the wheel: ready, on the levels
+     * and in the overflow.
+     */
+    void compact(TC)
+    {
+	Wheel w;
+	std::vector<Timer*> tm;
+	std::vector<std::unique_ptr<Timer>> v;
+	for (int i = 0; i < 26; i++) {
+	    v.emplace_back(new Timer {seconds{i < 3 ? 0 : i*i*i*i*i}});
+	    tm.push_back(v.back().get());
+	    w.insert(t0 + v.back()->dt, v.back().get());
+	}
+	for (int i = 0; i < 26; i++) {
+	    if (i%3) v[i]->cancelled = true;
+	}
+	assert_eq(w.cancelled(), 17);
+
+	assert_eq(w.purge(), 17);
+	assert_eq(w.cancelled(), 0);
+	assert_eq(w.size(), 9);
+	v[1]->cancelled = false;
+	assert_eq(w.cancelled(), 0);
+	assert_eq(drain(w, t0 + hours{24*365}, tm), "adgjmpsvy");
+    }
+
+    void batch(TC)
+    {
+	Wheel w;
+	Timer a {minutes{1}};
+	Timer b {minutes{2}};
+	Timer c {minutes{2}};
+	const std::vector<Timer*> tm {&a, &b, &c};
+
+	w.insert(t0 + minutes{1}, &b);
+	Schedule::Entry v[] = {{t0 + minutes{1}, &a},
+			       {t0 + minutes{2}, &c},
+			       {t0 + minutes{2}, &b}};
+	w.insert(v, v+3);
+
+	assert_eq(drain(w, t0 + minutes{5}, tm), "acb");
+    }
+
+    void clock(TC)
+    {
+	Clock clock {std::unique_ptr<Schedule>{new Wheel}};
+	Timer A {minutes{10}, true};
+	Timer B {minutes{15}};
+	Timer C {minutes{30}};
+	const std::vector<Timer*> tm {&A, &B, &C};
+
+	clock.add(t0, &B);
+	clock.add(t0, &C);
+	clock.add(t0 - minutes{5}, &A);
+
+	auto assert_res = [&tm] (const Clock::Ramifications& res,
+				 const char* elapsed, Clock::duration snooze) {
+	    std::string s;
+	    for (const Timer* p : res.elapsed) {
+		s.push_back('A' + (std::find(begin(tm), end(tm), p) - begin(tm)));
+	    }
+	    assert_eq(s, elapsed);
+	    assert_eq(res.snooze.count(), snooze.count());
+	};
+
+	assert_res(clock.set(t0 + minutes{14}), "A", minutes{1});
+	assert_res(clock.set(t0 + minutes{20}), "BA", minutes{5});
+	assert_res(clock.set(t0 + minutes{40}), "ACA", minutes{5});
+	assert_res(clock.set(t0 + hours{24}), std::string(140, 'A').c_str(), minutes{5});
+    }
+}
@@ -0,0 +1,333 @@
+#include "wheel.h"
+
+#include <algorithm>
+
+using showtime::Wheel;
+
+namespace {
+
+    constexpr std::uint64_t bit(unsigned j) { return std::uint64_t{1} << j; }
+}
+
+bool Wheel::Item::operator< (const Item& other) const
+{
+    if (e.t != other.e.t) return e.t < other.e.t;
+    return seq < other.seq;
+}
+
+/**
+ * A wheel with a certain granularity. A fine tick (or a coarse
+ * one) doesn't make timers less exact, but 64^levels ticks is the
+ * range which doesn't need the overflow bucket.
+ */
+Wheel::Wheel(Clock::duration tick)
+    : g {tick}
+{}
+
+Wheel::~Wheel()
+{
+    for (Item& item : ready) hook(item.e.tm).s = nullptr;
+    for (auto& level : slot) {
+	for (Slot& s : level) {
+	    for (Item& item : s) hook(item.e.tm).s = nullptr;
+	}
+    }
+    for (Item& item : overflow) hook(item.e.tm).s = nullptr;
+}
+
+void Wheel::insert(time_point t, Timer* const tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s) h.s->remove(tm);
+
+    if (!n) {
+	/* An empty wheel might as well move to the time the timer
+	 * was added, instead of being too far back to hold it.
+	 */
+	now = tick(t - tm->dt);
+    }
+
+    const Item item {{t, tm}, seq++};
+    place(item);
+    n++;
+
+    if (cached && tick(t) > now && item < best) best = item;
+}
+
+const Wheel::Entry* Wheel::front()
+{
+    if (!ready.empty()) return &ready.front().e;
+
+    if (!cached) {
+	const Item* const p = first_waiting();
+	if (!p) return nullptr;
+	best = *p;
+	cached = true;
+    }
+    return &best.e;
+}
+
+bool Wheel::pop(time_point t, Entry& e)
+{
+    advance(tick(t));
+    if (ready.empty() || ready.front().e.t > t) return false;
+
+    e = ready.front().e;
+    take_ready(0);
+    hook(e.tm).s = nullptr;
+    n--;
+    return true;
+}
+
+std::size_t Wheel::size() const
+{
+    return n;
+}
+
+/**
+ * The entries are all over the place, so this means sorting them.
+ */
+void Wheel::list(std::vector<Entry>& v) const
+{
+    std::vector<Item> items {ready};
+    for (auto& level : slot) {
+	for (const Slot& s : level) items.insert(items.end(), s.begin(), s.end());
+    }
+    items.insert(items.end(), overflow.begin(), overflow.end());
+    std::sort(begin(items), end(items));
+    for (const Item& item : items) v.push_back(item.e);
+}
+
+void Wheel::remove(Timer* tm)
+{
+    Timer::Hook& h = hook(tm);
+    if (h.s != this) return;
+
+    if (h.where==in_ready) {
+	take_ready(h.n);
+    }
+    else if (h.where==in_overflow) {
+	take(overflow, h.n);
+    }
+    else {
+	const unsigned l = (h.where - 1) >> bits;
+	const unsigned j = (h.where - 1) & (bit(bits) - 1);
+	Slot& s = slot[l][j];
+	take(s, h.n);
+	if (s.empty()) occupied[l] &= ~bit(j);
+    }
+    h.s = nullptr;
+    n--;
+    if (cached && best.e.tm==tm) cached = false;
+}
+
+/**
+ * Sieving each slot, and the ready heap, which then has to be made a
+ * heap again.
+ */
+void Wheel::compact()
+{
+    sieve(ready);
+    for (std::size_t i = ready.size()/2; i--; ) sift_down(i);
+
+    for (unsigned l = 0; l < levels; l++) {
+	for (unsigned j = 0; j < bit(bits); j++) {
+	    if (!(occupied[l] & bit(j))) continue;
+	    Slot& s = slot[l][j];
+	    sieve(s);
+	    if (s.empty()) occupied[l] &= ~bit(j);
+	}
+    }
+    sieve(overflow);
+    cached = false;
+}
+
+/* The tick containing t. Times before the epoch are all in tick 0.
+ */
+std::uint64_t Wheel::tick(time_point t) const
+{
+    const auto dt = t.time_since_epoch();
+    if (dt.count() < 0) return 0;
+    return dt / g;
+}
+
+/* Put an item where it belongs, relative to the current tick: among
+ * the ready ones, in the lowest level which separates it from now, or
+ * in the overflow.
+ */
+void Wheel::place(const Item& item)
+{
+    const std::uint64_t t = tick(item.e.t);
+    if (t <= now) {
+	push_ready(item);
+	return;
+    }
+
+    const std::uint64_t diff = t ^ now;
+    for (unsigned l = 0; l < levels; l++) {
+	if (diff >> (bits*(l+1))) continue;
+	const unsigned j = (t >> (bits*l)) & (bit(bits) - 1);
+	put(slot[l][j], 1 + (l << bits) + j, item);
+	occupied[l] |= bit(j);
+	return;
+    }
+    put(overflow, in_overflow, item);
+}
+
+void Wheel::put(Slot& s, unsigned where, const Item& item)
+{
+    Timer::Hook& h = hook(item.e.tm);
+    h.s = this;
+    h.n = s.size();
+    h.where = where;
+    s.push_back(item);
+}
+
+/* Remove item i from a slot (or the overflow), by moving the last
+ * one into its place.
+ */
+void Wheel::take(Slot& s, std::size_t i)
+{
+    if (i+1 != s.size()) {
+	s[i] = s.back();
+	hook(s[i].e.tm).n = i;
+    }
+    s.pop_back();
+}
+
+/* Drop the cancelled items from a slot (or the overflow, or the
+ * ready ones), keeping the order of the rest.
+ */
+void Wheel::sieve(Slot& s)
+{
+    std::size_t j = 0;
+    for (const Item& item : s) {
+	Timer::Hook& h = hook(item.e.tm);
+	if (item.e.tm->cancelled) {
+	    h.s = nullptr;
+	    n--;
+	    continue;
+	}
+	h.n = j;
+	s[j++] = item;
+    }
+    s.resize(j);
+}
+
+/* The ready items form a binary min-heap, on (time, seq). Unlike
+ * std::push_heap and friends, this one keeps the hooks up to date.
+ */
+void Wheel::push_ready(const Item& item)
+{
+    ready.push_back(item);
+    Timer::Hook& h = hook(item.e.tm);
+    h.s = this;
+    h.where = in_ready;
+    sift_up(ready.size() - 1);
+}
+
+void Wheel::take_ready(std::size_t i)
+{
+    const std::size_t last = ready.size() - 1;
+    if (i != last) {
+	set_ready(i, ready[last]);
+	ready.pop_back();
+	sift_down(i);
+	sift_up(i);
+    }
+    else {
+	ready.pop_back();
+    }
+}
+
+void Wheel::set_ready(std::size_t i, const Item& item)
+{
+    ready[i] = item;
+    hook(item.e.tm).n = i;
+}
+
+void Wheel::sift_up(std::size_t i)
+{
+    const Item item = ready[i];
+    while (i) {
+	const std::size_t parent = (i-1)/2;
+	if (!(item < ready[parent])) break;
+	set_ready(i, ready[parent]);
+	i = parent;
+    }
+    set_ready(i, item);
+}
+
+void Wheel::sift_down(std::size_t i)
+{
+    const std::size_t size = ready.size();
+    const Item item = ready[i];
+    while (2*i + 1 < size) {
+	std::size_t child = 2*i + 1;
+	if (child+1 < size && ready[child+1] < ready[child]) child++;
+	if (!(ready[child] < item)) break;
+	set_ready(i, ready[child]);
+	i = child;
+    }
+    set_ready(i, item);
+}
+
+/* Move the current tick forward to t. At each level, the slots we
+ * pass are due, and the one we land in is spread out on the levels
+ * below (or made ready). Levels which aren't affected are left
+ * alone, but levels are visited bottom-up so that nothing lands in a
+ * level which is yet to be visited.
+ *
+ * Only occupied slots are visited, so a long jump costs no more than
+ * a short one.
+ */
+void Wheel::advance(const std::uint64_t t)
+{
+    if (t <= now) return;
+    const std::uint64_t was = now;
+    now = t;
+
+    for (unsigned l = 0; l < levels; l++) {
+	const std::uint64_t a = was >> (bits*l);
+	const std::uint64_t b = t >> (bits*l);
+	if (a==b) return;
+
+	const std::uint64_t base = a >> bits << bits;
+	std::uint64_t occ = occupied[l];
+	while (occ) {
+	    const unsigned j = __builtin_ctzll(occ);
+	    occ &= occ - 1;
+	    if ((base | j) > b) break;
+
+	    Slot& s = slot[l][j];
+	    for (const Item& item : s) place(item);
+	    s.clear();
+	    occupied[l] &= ~bit(j);
+	    cached = false;
+	}
+    }
+
+    if ((was >> (bits*levels)) == (t >> (bits*levels))) return;
+    if (overflow.empty()) return;
+
+    Slot s;
+    s.swap(overflow);
+    for (const Item& item : s) place(item);
+    cached = false;
+}
+
+/* The first item still waiting on the wheel (not ready), or nullptr.
+ * The first occupied slot on the lowest occupied level holds it,
+ * somewhere.
+ */
+const Wheel::Item* Wheel::first_waiting()
+{
+    const Slot* s = &overflow;
+    for (unsigned l = 0; l < levels; l++) {
+	if (!occupied[l]) continue;
+	s = &slot[l][__builtin_ctzll(occupied[l])];
+	break;
+    }
+    if (s->empty()) return nullptr;
+    return &*std::min_element(begin(*s), end(*s));
+}
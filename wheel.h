@@ -0,0 +1,93 @@
+/* Copyright (c) 2026 Jrgen Grahn
+ * All rights reserved.
+ */
+#ifndef SHOWTIME_WHEEL_H_
+#define SHOWTIME_WHEEL_H_
+
+#include "showtime.h"
+
+#include <cstdint>
+
+namespace showtime {
+
+    /**
+     * A hierarchical timing wheel, as a Schedule.
+     *
+     * Time is divided into ticks (1 ms by default). The wheel has
+     * 'levels' levels of 64 slots each; a slot at level 0 is one
+     * tick, one at level 1 is 64 ticks and so on. A timer goes into
+     * the lowest level which can tell it apart from the current
+     * tick, and moves down as time approaches it; timers further
+     * off than the top level can express wait in an overflow bucket.
+     * So adding and removing is O(1), and so is expiry, amortized.
+     *
+     * Due timers move to a small heap where they are, once again,
+     * exactly ordered; 'tick' doesn't affect the precision, only how
+     * soon things become due.
+     *
+     * The wheel keeps its own notion of current time, moved forward
+     * by pop(t). Moving backwards is harmless, but inefficient:
+     * timers before the current tick go straight to the heap.
+     */
+    class Wheel : public Schedule {
+    public:
+	explicit Wheel(Clock::duration tick = std::chrono::milliseconds{1});
+	Wheel(const Wheel&) = delete;
+	Wheel& operator= (const Wheel&) = delete;
+	~Wheel();
+
+	using Schedule::insert;
+	void insert(time_point t, Timer* tm) override;
+	const Entry* front() override;
+	bool pop(time_point t, Entry& e) override;
+	void remove(Timer* tm) override;
+	std::size_t size() const override;
+	void list(std::vector<Entry>& v) const override;
+
+	static constexpr unsigned levels = 5;
+
+    private:
+	void compact() override;
+
+	static constexpr unsigned bits = 6;
+
+	struct Item {
+	    Entry e;
+	    std::uint64_t seq;
+	    bool operator< (const Item& other) const;
+	};
+	using Slot = std::vector<Item>;
+
+	const Clock::duration g;
+	std::uint64_t now = 0;
+	std::uint64_t seq = 0;
+	std::size_t n = 0;
+
+	std::vector<Item> ready;
+	Slot slot[levels][1 << bits];
+	std::uint64_t occupied[levels] = {};
+	Slot overflow;
+
+	bool cached = false;
+	Item best;
+
+	static constexpr unsigned in_ready = 0;
+	static constexpr unsigned in_overflow = 1 + (levels << bits);
+
+	std::uint64_t tick(time_point t) const;
+	void place(const Item& item);
+	void put(Slot& s, unsigned where, const Item& item);
+	void take(Slot& s, std::size_t i);
+	void sieve(Slot& s);
+
+	void push_ready(const Item& item);
+	void take_ready(std::size_t i);
+	void set_ready(std::size_t i, const Item& item);
+	void sift_up(std::size_t i);
+	void sift_down(std::size_t i);
+
+	void advance(std::uint64_t t);
+	const Item* first_waiting();
+    };
+}
+#endif